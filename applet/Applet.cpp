@@ -27,6 +27,8 @@
 #include "PlaylistModel.h"
 #include "SeekSlider.h"
 #include "DBusInterface.h"
+#include "IdleManager.h"
+#include "Instrumentation.h"
 
 #include <QtCore/QTime>
 #include <QtCore/QTimer>
@@ -34,6 +36,7 @@
 #include <QtCore/QTimerEvent>
 #include <QtGui/QKeyEvent>
 #include <QtGui/QGraphicsLinearLayout>
+#include <QtGui/QGraphicsSceneHoverEvent>
 #include <QtGui/QGraphicsSceneResizeEvent>
 #include <QtGui/QGraphicsSceneDragDropEvent>
 
@@ -45,6 +48,7 @@
 #include <KInputDialog>
 #include <KWindowSystem>
 #include <KConfigDialog>
+#include <KGlobalSettings>
 
 #include <Plasma/Corona>
 #include <Plasma/Slider>
@@ -63,11 +67,18 @@ Applet::Applet(QObject *parent, const QVariantList &args) : Plasma::Applet(paren
     m_dBusInterface(NULL),
     m_volumeDialog(NULL),
     m_jumpToPositionDialog(NULL),
+    m_debugDialog(NULL),
+    m_debugReport(NULL),
     m_togglePlaylist(0),
     m_hideToolTip(0),
     m_updateToolTip(0),
-    m_initialized(false)
+    m_updateDebugDialog(0),
+    m_initialized(false),
+    m_toolTipVisible(false),
+    m_firstPaintRecorded(false)
 {
+    m_startupTimer.start();
+
     KGlobal::locale()->insertCatalog("miniplayer");
 
     setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
@@ -75,7 +86,16 @@ Applet::Applet(QObject *parent, const QVariantList &args) : Plasma::Applet(paren
     setHasConfigurationInterface(true);
     setAcceptDrops(true);
 
-    MetaDataManager::createInstance(this);
+    MetaDataManager::createInstance();
+
+    connect(MetaDataManager::instance(), SIGNAL(urlChanged(KUrl)), m_player, SLOT(updateGain(KUrl)));
+    connect(MetaDataManager::instance(), SIGNAL(urlChanged(KUrl)), this, SLOT(metaDataChanged(KUrl)));
+
+    IdleManager::createInstance();
+
+    connect(m_player, SIGNAL(stateChanged(PlayerState)), IdleManager::instance(), SLOT(setPlayerState(PlayerState)));
+    connect(IdleManager::instance(), SIGNAL(idleChanged(bool)), MetaDataManager::instance(), SLOT(idleChanged(bool)), Qt::UniqueConnection);
+    connect(IdleManager::instance(), SIGNAL(idleChanged(bool)), m_player, SLOT(updateVideoActivity()));
 
     VideoWidget *videoWidget = new VideoWidget(this);
     QGraphicsWidget *controlsWidget = new QGraphicsWidget(this);
@@ -181,6 +201,8 @@ Applet::Applet(QObject *parent, const QVariantList &args) : Plasma::Applet(paren
 
 void Applet::init()
 {
+    Instrumentation::setEnabled(config().readEntry("enableInstrumentation", false));
+
     QTimer::singleShot(100, this, SLOT(configChanged()));
 
     connect(this, SIGNAL(activate()), this, SLOT(togglePlaylistDialog()));
@@ -218,6 +240,9 @@ void Applet::configChanged()
     m_player->setContrast(config().readEntry("contrast", 50));
     m_player->setHue(config().readEntry("hue", 50));
     m_player->setSaturation(config().readEntry("saturation", 50));
+    m_player->setCrossfadeDuration(config().readEntry("crossfadeDuration", 5000));
+
+    Instrumentation::setEnabled(configuration.readEntry("enableInstrumentation", false));
 
     if (!configuration.readEntry("enableDBus", false) && m_dBusInterface)
     {
@@ -232,6 +257,8 @@ void Applet::configChanged()
 
     if (!m_initialized)
     {
+        ScopedTimer timer("Applet::restoreSession");
+
         m_initialized = true;
 
         KConfigGroup playlistsConfiguration = config().group("Playlists");
@@ -252,6 +279,10 @@ void Applet::configChanged()
             track.keys[DescriptionKey] = trackConfiguration.readEntry("description", QString());
             track.keys[DateKey] = trackConfiguration.readEntry("date", QString());
             track.duration = trackConfiguration.readEntry("duration", -1);
+            track.gain = trackConfiguration.readEntry("gain", 0.0);
+            track.peak = trackConfiguration.readEntry("peak", -1.0);
+            track.hasGain = trackConfiguration.hasKey("gain");
+            track.fingerprint = trackConfiguration.readEntry("fingerprint", QByteArray());
 
             MetaDataManager::setMetaData(KUrl(trackConfiguration.readEntry("url", QString())), track);
         }
@@ -261,16 +292,18 @@ void Applet::configChanged()
         for (int i = 0; i < playlists.count(); ++i)
         {
             KConfigGroup playlistConfiguration = playlistsConfiguration.group(playlists.at(i));
-            int playlistId = m_playlistManager->createPlaylist(playlistConfiguration.readEntry("title", i18n("Default")), KUrl::List(playlistConfiguration.readEntry("tracks", QStringList())), LocalSource, playlistConfiguration.readEntry("id", i));
+            int playlistId = m_playlistManager->createPlaylist(playlistConfiguration.readEntry("title", i18n("Default")), KUrl::List(), LocalSource, playlistConfiguration.readEntry("id", i));
             PlaylistModel *playlist = m_playlistManager->playlist(playlistId);
 
             playlistsOrder[playlistId] = playlistConfiguration.readEntry("order", i);
 
+            playlist->setPendingTracks(playlistConfiguration.readEntry("tracks", QStringList()), playlistConfiguration.readEntry("currentTrack", 0));
             playlist->setCreationDate(playlistConfiguration.readEntry("creationDate", QDateTime()));
             playlist->setModificationDate(playlistConfiguration.readEntry("modificationDate", QDateTime()));
             playlist->setLastPlayedDate(playlistConfiguration.readEntry("lastPlayedDate", QDateTime()));
-            playlist->setCurrentTrack(playlistConfiguration.readEntry("currentTrack", 0));
             playlist->setPlaybackMode(static_cast<PlaybackMode>(playlistConfiguration.readEntry("playbackMode", static_cast<int>(LoopPlaylistMode))));
+            playlist->setWatchedDirectory(playlistConfiguration.readEntry("watchedDirectory", QString()));
+            playlist->setSourceFile(playlistConfiguration.readEntry("sourceFile", QString()), playlistConfiguration.readEntry("sourceHash", QByteArray()));
 
             if (playlistConfiguration.readEntry("isCurrent", false))
             {
@@ -304,6 +337,8 @@ void Applet::configChanged()
 
         connect(m_player, SIGNAL(modified()), this, SLOT(configSave()));
         connect(m_playlistManager, SIGNAL(modified()), this, SLOT(configSave()));
+
+        Instrumentation::record("Applet::startup", (m_startupTimer.nsecsElapsed() / 1000));
     }
 
     updateControls();
@@ -311,6 +346,8 @@ void Applet::configChanged()
 
 void Applet::configSave()
 {
+    ScopedTimer timer("Applet::configSave");
+
     KConfigGroup configuration = config();
     configuration.writeEntry("aspectRatio", static_cast<int>(m_player->aspectRatio()));
     configuration.writeEntry("mute", m_player->isAudioMuted());
@@ -319,6 +356,7 @@ void Applet::configSave()
     configuration.writeEntry("contrast", m_player->contrast());
     configuration.writeEntry("hue", m_player->hue());
     configuration.writeEntry("saturation", m_player->saturation());
+    configuration.writeEntry("crossfadeDuration", m_player->crossfadeDuration());
 
     if (m_playlistManager->isDialogVisible())
     {
@@ -357,6 +395,9 @@ void Applet::configSave()
         playlistConfiguration.writeEntry("modificationDate", playlist->modificationDate());
         playlistConfiguration.writeEntry("lastPlayedDate", playlist->lastPlayedDate());
         playlistConfiguration.writeEntry("playbackMode", static_cast<int>(playlist->playbackMode()));
+        playlistConfiguration.writeEntry("watchedDirectory", playlist->watchedDirectory());
+        playlistConfiguration.writeEntry("sourceFile", playlist->sourceFile());
+        playlistConfiguration.writeEntry("sourceHash", playlist->sourceHash());
         playlistConfiguration.writeEntry("currentTrack", playlist->currentTrack());
         playlistConfiguration.writeEntry("isCurrent", playlist->isCurrent());
 
@@ -384,6 +425,19 @@ void Applet::configSave()
         trackConfiguration.writeEntry("description", MetaDataManager::metaData(tracks.at(i), DescriptionKey, false));
         trackConfiguration.writeEntry("date", MetaDataManager::metaData(tracks.at(i), DateKey, false));
         trackConfiguration.writeEntry("duration", MetaDataManager::duration(tracks.at(i)));
+
+        const QByteArray fingerprint = MetaDataManager::track(tracks.at(i)).fingerprint;
+
+        if (!fingerprint.isEmpty())
+        {
+            trackConfiguration.writeEntry("fingerprint", fingerprint);
+        }
+
+        if (MetaDataManager::hasGain(tracks.at(i)))
+        {
+            trackConfiguration.writeEntry("gain", MetaDataManager::gain(tracks.at(i)));
+            trackConfiguration.writeEntry("peak", MetaDataManager::peak(tracks.at(i)));
+        }
     }
 
     emit configNeedsSaving();
@@ -448,8 +502,17 @@ void Applet::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
     event->ignore();
 }
 
+void Applet::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+{
+    IdleManager::instance()->notifyActivity();
+
+    Plasma::Applet::hoverEnterEvent(event);
+}
+
 void Applet::keyPressEvent(QKeyEvent *event)
 {
+    IdleManager::instance()->notifyActivity();
+
     switch (event->key())
     {
         case Qt::Key_PageDown:
@@ -506,6 +569,17 @@ void Applet::keyPressEvent(QKeyEvent *event)
                 m_playlistManager->closeDialog();
             }
 
+            break;
+        case Qt::Key_D:
+            if (event->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier))
+            {
+                toggleDebugDialog();
+            }
+            else
+            {
+                event->ignore();
+            }
+
             break;
         case Qt::Key_F:
             m_player->setFullScreen(!m_player->isFullScreen());
@@ -544,6 +618,8 @@ void Applet::keyPressEvent(QKeyEvent *event)
 
 void Applet::timerEvent(QTimerEvent *event)
 {
+    Instrumentation::recordWakeup("Applet");
+
     if (event->timerId() == m_togglePlaylist)
     {
         togglePlaylistDialog();
@@ -565,6 +641,10 @@ void Applet::timerEvent(QTimerEvent *event)
     {
         updateToolTip();
     }
+    else if (event->timerId() == m_updateDebugDialog)
+    {
+        updateDebugDialog();
+    }
     else
     {
         killTimer(event->timerId());
@@ -573,18 +653,33 @@ void Applet::timerEvent(QTimerEvent *event)
 
 void Applet::stateChanged(PlayerState state)
 {
+    if (m_toolTipVisible && state == PlayingState && !m_updateToolTip)
+    {
+        m_updateToolTip = startTimer(1000);
+    }
+    else if (state != PlayingState && m_updateToolTip)
+    {
+        killTimer(m_updateToolTip);
+
+        m_updateToolTip = 0;
+    }
+
     if (state == PlayingState && m_hideToolTip == 0)
     {
         QTimer::singleShot(500, this, SLOT(showToolTip()));
     }
     else if (state == StoppedState)
     {
+        m_toolTipUrl = KUrl();
+
         Plasma::ToolTipManager::self()->clearContent(this);
     }
 }
 
 void Applet::metaDataChanged()
 {
+    m_toolTipUrl = KUrl();
+
     if (m_player->state() != StoppedState && m_player->position() < 150 && m_hideToolTip == 0)
     {
         updateToolTip();
@@ -668,6 +763,66 @@ void Applet::toggleJumpToPosition()
     }
 }
 
+void Applet::toggleDebugDialog()
+{
+    if (!m_debugDialog)
+    {
+        m_debugDialog = new KDialog;
+        m_debugDialog->setCaption(i18n("Timings"));
+        m_debugDialog->setButtons(KDialog::Close | KDialog::User1);
+        m_debugDialog->setButtonText(KDialog::User1, i18n("Reset"));
+        m_debugDialog->setWindowModality(Qt::NonModal);
+
+        m_debugReport = new QPlainTextEdit(m_debugDialog);
+        m_debugReport->setReadOnly(true);
+        m_debugReport->setLineWrapMode(QPlainTextEdit::NoWrap);
+        m_debugReport->setFont(KGlobalSettings::fixedFont());
+
+        m_debugDialog->setMainWidget(m_debugReport);
+
+        connect(this, SIGNAL(destroyed()), m_debugDialog, SLOT(deleteLater()));
+        connect(m_debugDialog, SIGNAL(user1Clicked()), this, SLOT(resetInstrumentation()));
+    }
+
+    if (m_debugDialog->isVisible())
+    {
+        m_debugDialog->close();
+    }
+    else
+    {
+        Instrumentation::setEnabled(true);
+
+        updateDebugDialog();
+
+        m_debugDialog->show();
+
+        m_updateDebugDialog = startTimer(1000);
+    }
+}
+
+void Applet::updateDebugDialog()
+{
+    if (!m_debugDialog || !m_debugDialog->isVisible())
+    {
+        killTimer(m_updateDebugDialog);
+
+        m_updateDebugDialog = 0;
+
+        return;
+    }
+
+    const QString report = Instrumentation::report();
+
+    m_debugReport->setPlainText(report.isEmpty()?i18n("No samples recorded yet."):report);
+}
+
+void Applet::resetInstrumentation()
+{
+    Instrumentation::reset();
+
+    updateDebugDialog();
+}
+
 void Applet::toggleVolumeDialog()
 {
     if (!m_volumeDialog)
@@ -722,7 +877,12 @@ void Applet::togglePlaylistDialog()
 
 void Applet::toolTipAboutToShow()
 {
-    m_updateToolTip = startTimer(1000);
+    m_toolTipVisible = true;
+
+    if (m_player->state() == PlayingState && !m_updateToolTip)
+    {
+        m_updateToolTip = startTimer(1000);
+    }
 
     updateToolTip();
 }
@@ -734,6 +894,7 @@ void Applet::toolTipHidden()
     killTimer(m_updateToolTip);
 
     m_updateToolTip = 0;
+    m_toolTipVisible = false;
 }
 
 void Applet::showToolTip()
@@ -753,6 +914,18 @@ void Applet::showToolTip()
     }
 }
 
+void Applet::metaDataChanged(const KUrl &url)
+{
+    if (m_toolTipUrl.isEmpty() || url != m_toolTipUrl)
+    {
+        return;
+    }
+
+    m_toolTipUrl = KUrl();
+
+    updateToolTip();
+}
+
 void Applet::hideToolTip()
 {
     Plasma::ToolTipManager::self()->hide(this);
@@ -760,22 +933,32 @@ void Applet::hideToolTip()
 
 void Applet::updateToolTip()
 {
-    if (!m_updateToolTip && !Plasma::ToolTipManager::self()->isVisible(this))
+    if (!m_toolTipVisible && !Plasma::ToolTipManager::self()->isVisible(this))
     {
         return;
     }
 
-    Plasma::ToolTipContent data;
+    if (m_player->state() == StoppedState)
+    {
+        m_toolTipUrl = KUrl();
 
-    if (m_player->state() != StoppedState)
+        Plasma::ToolTipManager::self()->setContent(this, Plasma::ToolTipContent());
+
+        return;
+    }
+
+    if (m_toolTipUrl.isEmpty() || m_toolTipUrl != m_player->url())
     {
-        data.setMainText(QString("%1 - %2").arg(m_player->metaData(ArtistKey)).arg(m_player->metaData(TitleKey)));
-        data.setSubText((m_player->duration() > 0)?i18n("Position: %1 / %2", MetaDataManager::timeToString(m_player->position()), MetaDataManager::timeToString(m_player->duration())):"");
-        data.setImage(MetaDataManager::icon(m_player->url()).pixmap(IconSize(KIconLoader::Desktop)));
-        data.setAutohide(true);
+        m_toolTipUrl = m_player->url();
+        m_toolTipContent = Plasma::ToolTipContent();
+        m_toolTipContent.setMainText(QString("%1 - %2").arg(m_player->metaData(ArtistKey)).arg(m_player->metaData(TitleKey)));
+        m_toolTipContent.setImage(MetaDataManager::icon(m_toolTipUrl).pixmap(IconSize(KIconLoader::Desktop)));
+        m_toolTipContent.setAutohide(true);
     }
 
-    Plasma::ToolTipManager::self()->setContent(this, data);
+    m_toolTipContent.setSubText((m_player->duration() > 0)?i18n("Position: %1 / %2", MetaDataManager::timeToString(m_player->position()), MetaDataManager::timeToString(m_player->duration())):"");
+
+    Plasma::ToolTipManager::self()->setContent(this, m_toolTipContent);
 }
 
 void Applet::updateControls()
@@ -876,8 +1059,35 @@ PlaylistManager* Applet::playlistManager()
     return m_playlistManager;
 }
 
+void Applet::paintInterface(QPainter *painter, const QStyleOptionGraphicsItem *option, const QRect &contentsRect)
+{
+    if (m_startupTimer.isValid() && !m_firstPaintRecorded)
+    {
+        m_firstPaintRecorded = true;
+
+        Instrumentation::record("Applet::firstPaint", (m_startupTimer.nsecsElapsed() / 1000));
+    }
+
+    Plasma::Applet::paintInterface(painter, option, contentsRect);
+}
+
+QVariant Applet::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (change == ItemVisibleHasChanged && IdleManager::instance())
+    {
+        IdleManager::instance()->setHidden(this, !value.toBool());
+    }
+
+    return Plasma::Applet::itemChange(change, value);
+}
+
 bool Applet::eventFilter(QObject *object, QEvent *event)
 {
+    if (event->type() == QEvent::KeyPress || event->type() == QEvent::MouseButtonPress || event->type() == QEvent::Wheel)
+    {
+        IdleManager::instance()->notifyActivity();
+    }
+
     if (event->type() == QEvent::KeyPress)
     {
         keyPressEvent(static_cast<QKeyEvent*>(event));
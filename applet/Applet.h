@@ -21,10 +21,16 @@
 #ifndef MINIPLAYERAPPLET_HEADER
 #define MINIPLAYERAPPLET_HEADER
 
+#include <QtCore/QElapsedTimer>
+
+#include <QtGui/QPlainTextEdit>
+
+#include <KUrl>
 #include <KDialog>
 
 #include <Plasma/Applet>
 #include <Plasma/Dialog>
+#include <Plasma/ToolTipContent>
 
 #include "Constants.h"
 
@@ -65,17 +71,24 @@ class Applet : public Plasma::Applet
         void dragLeaveEvent(QGraphicsSceneDragDropEvent *event);
         void dropEvent(QGraphicsSceneDragDropEvent *event);
         void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event);
+        void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
         void keyPressEvent(QKeyEvent *event);
         void timerEvent(QTimerEvent *event);
+        void paintInterface(QPainter *painter, const QStyleOptionGraphicsItem *option, const QRect &contentsRect);
+        QVariant itemChange(GraphicsItemChange change, const QVariant &value);
 
     protected slots:
         void stateChanged(PlayerState state);
         void metaDataChanged();
+        void metaDataChanged(const KUrl &url);
         void openFiles();
         void openUrl();
         void jumpToPosition();
         void toggleJumpToPosition();
         void toggleVolumeDialog();
+        void toggleDebugDialog();
+        void updateDebugDialog();
+        void resetInstrumentation();
         void toggleFullScreen();
         void togglePlaylistDialog();
         void showToolTip();
@@ -91,10 +104,18 @@ class Applet : public Plasma::Applet
         QMap<QString, QGraphicsProxyWidget*> m_controls;
         QList<QAction*> m_actions;
         KDialog *m_jumpToPositionDialog;
+        KDialog *m_debugDialog;
+        QPlainTextEdit *m_debugReport;
         int m_togglePlaylist;
         int m_hideToolTip;
         int m_updateToolTip;
+        int m_updateDebugDialog;
+        Plasma::ToolTipContent m_toolTipContent;
+        KUrl m_toolTipUrl;
+        QElapsedTimer m_startupTimer;
         bool m_initialized;
+        bool m_toolTipVisible;
+        bool m_firstPaintRecorded;
         Ui::jumpToPosition m_jumpToPositionUi;
         Ui::volume m_volumeUi;
 };
@@ -0,0 +1,575 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "Benchmark.h"
+#include "MetaDataManager.h"
+#include "Instrumentation.h"
+#include "PlaylistModel.h"
+#include "PlaylistReader.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QTextStream>
+#include <QtCore/QDataStream>
+#include <QtCore/QElapsedTimer>
+
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtGui/QApplication>
+#include <QtGui/QGraphicsScene>
+#include <QtGui/QGraphicsRectItem>
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KComponentData>
+
+namespace MiniPlayer
+{
+
+Benchmark::Benchmark(QObject *parent, qreal scale) : QObject(parent),
+    m_scale(scale)
+{
+}
+
+void Benchmark::run()
+{
+    Instrumentation::setEnabled(true);
+    Instrumentation::reset();
+
+    benchmarkPlaylistModel();
+    benchmarkM3u();
+    benchmarkXspf();
+    benchmarkConfiguration();
+    benchmarkMetaData();
+    benchmarkVideoRepaint();
+}
+
+void Benchmark::benchmarkPlaylistModel()
+{
+    const int count = scaled(100000);
+    KUrl::List tracks;
+    tracks.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const KUrl url(QString("/benchmark/Artist %1/Album %2/%3.ogg").arg(i % 500).arg(i % 2000).arg(i));
+        Track track;
+        track.keys[ArtistKey] = QString("Artist %1").arg(i % 500);
+        track.keys[TitleKey] = QString("Track %1").arg((i * 7919) % count);
+        track.keys[AlbumKey] = QString("Album %1").arg(i % 2000);
+        track.keys[TrackNumberKey] = QString::number((i % 20) + 1);
+        track.duration = (120000 + ((i * 131) % 240000));
+
+        MetaDataManager::setMetaData(url, track);
+
+        tracks.append(url);
+    }
+
+    PlaylistModel *playlist = new PlaylistModel(this, 0, "Benchmark");
+    QElapsedTimer timer;
+    timer.start();
+
+    playlist->restoreTracks(tracks, 0);
+
+    record("PlaylistModel::restoreTracks", count, (timer.nsecsElapsed() / 1000));
+
+    timer.restart();
+
+    playlist->sort(TitleColumn, Qt::AscendingOrder);
+
+    record("PlaylistModel::sort(title)", count, (timer.nsecsElapsed() / 1000));
+
+    timer.restart();
+
+    playlist->sort(DurationColumn, Qt::DescendingOrder);
+
+    record("PlaylistModel::sort(duration)", count, (timer.nsecsElapsed() / 1000));
+
+    timer.restart();
+
+    int visibleTracks = 0;
+
+    for (int i = 0; i < playlist->trackCount(); ++i)
+    {
+        for (int j = FileNameColumn; j <= DurationColumn; ++j)
+        {
+            if (playlist->index(i, j).data(Qt::DisplayRole).toString().contains("track 1", Qt::CaseInsensitive))
+            {
+                ++visibleTracks;
+
+                break;
+            }
+        }
+    }
+
+    record("PlaylistModel::filter", visibleTracks, (timer.nsecsElapsed() / 1000));
+
+    delete playlist;
+
+    clearMetaData();
+}
+
+void Benchmark::benchmarkM3u()
+{
+    const int count = scaled(500000);
+    const QString path = (m_directory.name() + "benchmark.m3u");
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        return;
+    }
+
+    QTextStream stream(&file);
+    stream << "#EXTM3U\n";
+
+    for (int i = 0; i < count; ++i)
+    {
+        stream << QString("#EXTINF:%1,Artist %2 - Track %3\n").arg(120 + (i % 240)).arg(i % 500).arg(i);
+        stream << QString("http://benchmark.invalid/Artist%1/%2.ogg\n").arg(i % 500).arg(i);
+    }
+
+    file.close();
+
+    m_processedTracks.clear();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    new PlaylistReader(this, KUrl::List(KUrl(path)), -1, NoReaction);
+
+    record("PlaylistReader::readM3u", m_processedTracks.count(), (timer.nsecsElapsed() / 1000));
+
+    QFile::remove(path);
+
+    clearMetaData();
+}
+
+void Benchmark::benchmarkXspf()
+{
+    const int count = scaled(100000);
+    const QString path = (m_directory.name() + "benchmark.xspf");
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        return;
+    }
+
+    QTextStream stream(&file);
+    stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<playlist version=\"1\" xmlns=\"http://xspf.org/ns/0/\">\n<trackList>\n";
+
+    for (int i = 0; i < count; ++i)
+    {
+        stream << QString("<track><location>http://benchmark.invalid/Artist%1/%2.ogg</location><title>Track %2</title><creator>Artist %1</creator><album>Album %3</album><trackNum>%4</trackNum><duration>%5</duration></track>\n").arg(i % 500).arg(i).arg(i % 2000).arg((i % 20) + 1).arg(120000 + (i % 240000));
+    }
+
+    stream << "</trackList>\n</playlist>\n";
+
+    file.close();
+
+    m_processedTracks.clear();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    new PlaylistReader(this, KUrl::List(KUrl(path)), -1, NoReaction);
+
+    record("PlaylistReader::readXspf", m_processedTracks.count(), (timer.nsecsElapsed() / 1000));
+
+    QFile::remove(path);
+
+    clearMetaData();
+}
+
+void Benchmark::benchmarkConfiguration()
+{
+    const int count = scaled(100000);
+    const QString path = (m_directory.name() + "benchmarkrc");
+    QStringList tracks;
+    tracks.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const KUrl url(QString("/benchmark/Artist %1/Album %2/%3.ogg").arg(i % 500).arg(i % 2000).arg(i));
+        Track track;
+        track.keys[ArtistKey] = QString("Artist %1").arg(i % 500);
+        track.keys[TitleKey] = QString("Track %1").arg(i);
+        track.keys[AlbumKey] = QString("Album %1").arg(i % 2000);
+        track.duration = (120000 + (i % 240000));
+
+        MetaDataManager::setMetaData(url, track);
+
+        tracks.append(url.pathOrUrl());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    {
+        KConfig configuration(path, KConfig::SimpleConfig);
+        KConfigGroup playlistConfiguration = configuration.group("Playlists").group("0");
+        playlistConfiguration.writeEntry("id", 0);
+        playlistConfiguration.writeEntry("title", "Benchmark");
+        playlistConfiguration.writeEntry("tracks", tracks);
+        playlistConfiguration.writeEntry("currentTrack", 0);
+
+        KConfigGroup metaDataConfiguration = configuration.group("MetaData");
+        const KUrl::List urls = MetaDataManager::tracks();
+
+        for (int i = 0; i < urls.count(); ++i)
+        {
+            KConfigGroup trackConfiguration = metaDataConfiguration.group(QString::number(i));
+            trackConfiguration.writeEntry("url", urls.at(i));
+            trackConfiguration.writeEntry("artist", MetaDataManager::metaData(urls.at(i), ArtistKey, false));
+            trackConfiguration.writeEntry("title", MetaDataManager::metaData(urls.at(i), TitleKey, false));
+            trackConfiguration.writeEntry("album", MetaDataManager::metaData(urls.at(i), AlbumKey, false));
+            trackConfiguration.writeEntry("duration", MetaDataManager::duration(urls.at(i)));
+        }
+
+        configuration.sync();
+    }
+
+    record("Configuration::save", count, (timer.nsecsElapsed() / 1000));
+
+    clearMetaData();
+
+    timer.restart();
+
+    {
+        KConfig configuration(path, KConfig::SimpleConfig);
+        KConfigGroup metaDataConfiguration = configuration.group("MetaData");
+        const QStringList groups = metaDataConfiguration.groupList();
+
+        for (int i = 0; i < groups.count(); ++i)
+        {
+            KConfigGroup trackConfiguration = metaDataConfiguration.group(groups.at(i));
+            Track track;
+            track.keys[ArtistKey] = trackConfiguration.readEntry("artist", QString());
+            track.keys[TitleKey] = trackConfiguration.readEntry("title", QString());
+            track.keys[AlbumKey] = trackConfiguration.readEntry("album", QString());
+            track.duration = trackConfiguration.readEntry("duration", -1);
+
+            MetaDataManager::setMetaData(KUrl(trackConfiguration.readEntry("url", QString())), track);
+        }
+
+        KConfigGroup playlistConfiguration = configuration.group("Playlists").group("0");
+        PlaylistModel *playlist = new PlaylistModel(this, 0, playlistConfiguration.readEntry("title", QString()));
+        playlist->setPendingTracks(playlistConfiguration.readEntry("tracks", QStringList()), playlistConfiguration.readEntry("currentTrack", 0));
+        playlist->load();
+
+        delete playlist;
+    }
+
+    record("Configuration::load", count, (timer.nsecsElapsed() / 1000));
+
+    QFile::remove(path);
+
+    clearMetaData();
+}
+
+void Benchmark::benchmarkMetaData()
+{
+    const int count = scaled(50);
+    const QString path = (m_directory.name() + "corpus/");
+    KUrl::List tracks;
+
+    QDir().mkpath(path);
+
+    for (int i = 0; i < count; ++i)
+    {
+        QFile file(path + QString("Artist %1 - Track %2.wav").arg(i % 10).arg(i));
+
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            continue;
+        }
+
+        const int samples = 8000;
+        QDataStream stream(&file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.writeRawData("RIFF", 4);
+        stream << quint32(36 + (samples * 2));
+        stream.writeRawData("WAVEfmt ", 8);
+        stream << quint32(16) << quint16(1) << quint16(1) << quint32(8000) << quint32(16000) << quint16(2) << quint16(16);
+        stream.writeRawData("data", 4);
+        stream << quint32(samples * 2);
+
+        for (int j = 0; j < samples; ++j)
+        {
+            stream << qint16(((i + 1) * (j % 64)) % 2048);
+        }
+
+        tracks.append(KUrl(file.fileName()));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    resolveTracks(tracks);
+
+    record("MetaDataManager::resolveMetaData", tracks.count(), (timer.nsecsElapsed() / 1000));
+
+    const QString movedPath = (m_directory.name() + "moved/");
+    KUrl::List movedTracks;
+
+    QDir().rename(path, movedPath);
+
+    for (int i = 0; i < tracks.count(); ++i)
+    {
+        movedTracks.append(KUrl(movedPath + tracks.at(i).fileName()));
+    }
+
+    timer.restart();
+
+    resolveTracks(movedTracks);
+
+    record("MetaDataManager::relinkTracks", movedTracks.count(), (timer.nsecsElapsed() / 1000));
+
+    for (int i = 0; i < movedTracks.count(); ++i)
+    {
+        QFile::remove(movedTracks.at(i).toLocalFile());
+    }
+
+    QDir().rmdir(movedPath);
+
+    clearMetaData();
+}
+
+void Benchmark::benchmarkVideoRepaint()
+{
+    const int seconds = scaled(60);
+    const QRectF proxyRect(0, 0, 400, 300);
+    const QRectF surfaceRect(0, 37.5, 400, 225);
+    QImage frame(surfaceRect.size().toSize(), QImage::Format_RGB32);
+    QImage target(QSize(400, 340), QImage::Format_ARGB32_Premultiplied);
+    QGraphicsScene scene(QRectF(0, 0, 400, 340));
+    scene.addRect(QRectF(0, 300, 400, 40), QPen(Qt::NoPen), QBrush(Qt::darkGray));
+    scene.addRect(proxyRect, QPen(Qt::NoPen), QBrush(Qt::black));
+
+    QGraphicsRectItem *surfaceItem = scene.addRect(surfaceRect, QPen(Qt::NoPen));
+    surfaceItem->setVisible(false);
+
+    QPainter painter(&target);
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < (seconds * 20); ++i)
+    {
+        scene.render(&painter, proxyRect, proxyRect);
+    }
+
+    record("VideoWidget::timerRepaintIdle", (seconds * 20), (timer.nsecsElapsed() / 1000));
+
+    surfaceItem->setVisible(true);
+
+    timer.restart();
+
+    for (int i = 0; i < (seconds * 20); ++i)
+    {
+        frame.fill(i);
+
+        surfaceItem->setBrush(QBrush(frame));
+
+        scene.render(&painter, proxyRect, proxyRect);
+    }
+
+    record("VideoWidget::timerRepaint", (seconds * 20), (timer.nsecsElapsed() / 1000));
+
+    timer.restart();
+
+    for (int i = 0; i < (seconds * 25); ++i)
+    {
+        frame.fill(i);
+
+        surfaceItem->setBrush(QBrush(frame));
+
+        scene.render(&painter, surfaceRect, surfaceRect);
+    }
+
+    record("VideoWidget::frameRepaint", (seconds * 25), (timer.nsecsElapsed() / 1000));
+}
+
+void Benchmark::resolveTracks(const KUrl::List &tracks)
+{
+    QEventLoop eventLoop;
+
+    connect(this, SIGNAL(resolved()), &eventLoop, SLOT(quit()));
+    connect(MetaDataManager::instance(), SIGNAL(resolutionProgressChanged()), this, SLOT(resolutionProgressChanged()));
+
+    QTimer::singleShot((10000 + (tracks.count() * 2000)), &eventLoop, SLOT(quit()));
+
+    MetaDataManager::resolveTracks(tracks);
+
+    if (MetaDataManager::resolutionProgress().value("pending").toInt() > 0)
+    {
+        eventLoop.exec();
+    }
+
+    disconnect(MetaDataManager::instance(), SIGNAL(resolutionProgressChanged()), this, SLOT(resolutionProgressChanged()));
+}
+
+void Benchmark::clearMetaData()
+{
+    const KUrl::List tracks = MetaDataManager::tracks();
+
+    for (int i = 0; i < tracks.count(); ++i)
+    {
+        MetaDataManager::removeMetaData(tracks.at(i));
+    }
+
+    QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+}
+
+void Benchmark::processedTracks(const KUrl::List &tracks, int index, PlayerReaction reaction)
+{
+    Q_UNUSED(index)
+    Q_UNUSED(reaction)
+
+    m_processedTracks = tracks;
+}
+
+void Benchmark::resolutionProgressChanged()
+{
+    if (MetaDataManager::resolutionProgress().value("pending").toInt() == 0)
+    {
+        emit resolved();
+    }
+}
+
+void Benchmark::record(const QString &name, int items, qint64 duration)
+{
+    QVariantMap result;
+    result["name"] = name;
+    result["items"] = items;
+    result["duration"] = duration;
+
+    m_results.append(result);
+}
+
+int Benchmark::scaled(int count) const
+{
+    return qMax(1, qRound(count * m_scale));
+}
+
+QString Benchmark::report() const
+{
+    QVariantMap report;
+    report["scale"] = m_scale;
+    report["benchmarks"] = m_results;
+    report["instrumentation"] = Instrumentation::statistics();
+
+    return toJson(report);
+}
+
+QString Benchmark::toJson(const QVariant &value)
+{
+    QStringList entries;
+
+    switch (value.type())
+    {
+        case QVariant::Map:
+            {
+                const QVariantMap map = value.toMap();
+                QVariantMap::const_iterator iterator;
+
+                for (iterator = map.constBegin(); iterator != map.constEnd(); ++iterator)
+                {
+                    entries.append(toJson(iterator.key()) + ": " + toJson(iterator.value()));
+                }
+
+                return ("{" + entries.join(", ") + "}");
+            }
+        case QVariant::List:
+            {
+                const QVariantList list = value.toList();
+
+                for (int i = 0; i < list.count(); ++i)
+                {
+                    entries.append(toJson(list.at(i)));
+                }
+
+                return ("[" + entries.join(", ") + "]");
+            }
+        case QVariant::Bool:
+            return (value.toBool()?"true":"false");
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Double:
+            return value.toString();
+        default:
+            break;
+    }
+
+    QString string = value.toString();
+    string.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n").replace('\t', "\\t");
+
+    return ("\"" + string + "\"");
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication application(argc, argv, false);
+    KComponentData componentData("miniplayerbenchmark");
+    const QStringList arguments = application.arguments();
+    QString output;
+    qreal scale = 1;
+
+    for (int i = 1; i < arguments.count(); ++i)
+    {
+        if (arguments.at(i) == "--scale" && (i + 1) < arguments.count())
+        {
+            scale = qMax((qreal) 0.0001, arguments.at(++i).toDouble());
+        }
+        else if (arguments.at(i) == "--output" && (i + 1) < arguments.count())
+        {
+            output = arguments.at(++i);
+        }
+    }
+
+    MiniPlayer::MetaDataManager::createInstance(&application);
+
+    MiniPlayer::Benchmark benchmark(&application, scale);
+    benchmark.run();
+
+    if (output.isEmpty())
+    {
+        QTextStream(stdout) << benchmark.report() << '\n';
+
+        return 0;
+    }
+
+    QFile file(output);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        return 1;
+    }
+
+    QTextStream(&file) << benchmark.report() << '\n';
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef MINIPLAYERBENCHMARK_HEADER
+#define MINIPLAYERBENCHMARK_HEADER
+
+#include <QtCore/QObject>
+#include <QtCore/QVariant>
+
+#include <KUrl>
+#include <KTempDir>
+
+#include "Constants.h"
+
+namespace MiniPlayer
+{
+
+class Benchmark : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit Benchmark(QObject *parent, qreal scale = 1);
+
+        void run();
+        QString report() const;
+
+    protected:
+        void benchmarkPlaylistModel();
+        void benchmarkM3u();
+        void benchmarkXspf();
+        void benchmarkConfiguration();
+        void benchmarkMetaData();
+        void benchmarkVideoRepaint();
+        void resolveTracks(const KUrl::List &tracks);
+        void clearMetaData();
+        void record(const QString &name, int items, qint64 duration);
+        int scaled(int count) const;
+        static QString toJson(const QVariant &value);
+
+    protected slots:
+        void processedTracks(const KUrl::List &tracks, int index, PlayerReaction reaction);
+        void resolutionProgressChanged();
+
+    private:
+        KTempDir m_directory;
+        KUrl::List m_processedTracks;
+        QVariantList m_results;
+        qreal m_scale;
+
+    signals:
+        void errorOccured(QString error);
+        void resolved();
+};
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+
+#ifndef MINIPLAYERDBUSDEBUGADAPTOR
+#define MINIPLAYERDBUSDEBUGADAPTOR
+
+#include <QtCore/QVariantMap>
+#include <QtDBus/QDBusAbstractAdaptor>
+
+namespace MiniPlayer
+{
+
+class DBusDebugAdaptor : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+
+    Q_CLASSINFO("D-Bus Interface", "org.kde.plasma.miniplayer.Debug")
+
+    Q_PROPERTY(bool Enabled READ Enabled WRITE setEnabled)
+
+    public:
+        explicit DBusDebugAdaptor(QObject *parent);
+
+        bool Enabled() const;
+
+    public slots:
+        QVariantMap Statistics() const;
+        QString Report() const;
+        void Reset() const;
+        void setEnabled(bool enabled) const;
+};
+
+}
+
+#endif
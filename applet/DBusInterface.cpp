@@ -21,11 +21,17 @@
 #include "DBusInterface.h"
 #include "DBusRootAdaptor.h"
 #include "DBusTrackListAdaptor.h"
+#include "DBusTrackListExtensionAdaptor.h"
 #include "DBusPlayerAdaptor.h"
 #include "DBusPlaylistsAdaptor.h"
+#include "DBusDebugAdaptor.h"
 #include "Applet.h"
 #include "Player.h"
 #include "PlaylistManager.h"
+#include "Instrumentation.h"
+
+#include <QtCore/QTimer>
+#include <QtCore/QMetaObject>
 
 #include <QtDBus/QDBusMessage>
 #include <QtDBus/QDBusConnection>
@@ -35,12 +41,17 @@
 namespace MiniPlayer
 {
 
-DBusInterface::DBusInterface(Applet* applet) : QObject(applet)
+DBusInterface::DBusInterface(Applet* applet) : QObject(applet),
+    m_flushScheduled(false)
 {
-    new DBusRootAdaptor(this, applet->player());
-    new DBusTrackListAdaptor(this, applet->player());
-    new DBusPlayerAdaptor(this, applet->player());
-    new DBusPlaylistsAdaptor(this, applet->playlistManager());
+    registerAdaptor(new DBusRootAdaptor(this, applet->player()), (QStringList() << "Fullscreen" << "CanSetFullscreen"));
+    DBusTrackListAdaptor *trackList = new DBusTrackListAdaptor(this, applet->player(), applet->config().readEntry("dBusTrackListLimit", 0));
+
+    registerAdaptor(trackList);
+    registerAdaptor(new DBusTrackListExtensionAdaptor(this, trackList), (QStringList() << "MetadataResolution"));
+    registerAdaptor(new DBusPlayerAdaptor(this, applet->player()), (QStringList() << "PlaybackStatus" << "LoopStatus" << "Shuffle" << "Volume" << "Metadata" << "CanGoNext" << "CanGoPrevious" << "CanPlay" << "CanPause" << "CanSeek"));
+    registerAdaptor(new DBusPlaylistsAdaptor(this, applet->playlistManager()), (QStringList() << "PlaylistCount" << "ActivePlaylist"));
+    new DBusDebugAdaptor(this);
 
     m_instance = QString("PlasmaMiniPlayer.instance%1_%2").arg(getpid()).arg(applet->id());
 
@@ -57,17 +68,122 @@ DBusInterface::~DBusInterface()
     connection.unregisterService("org.mpris.MediaPlayer2." + m_instance);
 }
 
+void DBusInterface::registerAdaptor(QObject *adaptor, const QStringList &properties)
+{
+    const QMetaObject *metaObject = adaptor->metaObject();
+    const QString interface = QString::fromLatin1(metaObject->classInfo(metaObject->indexOfClassInfo("D-Bus Interface")).value());
+
+    m_adaptors[interface] = adaptor;
+
+    for (int i = 0; i < properties.count(); ++i)
+    {
+        m_properties[interface][properties.at(i)] = adaptor->property(properties.at(i).toLatin1().constData());
+    }
+}
+
 void DBusInterface::updateProperties(const QString &interface, const QVariantMap &properties)
 {
-    QVariantList arguments;
-    arguments << interface;
-    arguments << properties;
-    arguments << QStringList();
+    QVariantMap::const_iterator iterator;
+
+    for (iterator = properties.constBegin(); iterator != properties.constEnd(); ++iterator)
+    {
+        m_changedProperties[interface][iterator.key()] = iterator.value();
+        m_invalidatedProperties[interface].remove(iterator.key());
+    }
+
+    if (!m_flushScheduled)
+    {
+        m_flushScheduled = true;
+
+        QTimer::singleShot(0, this, SLOT(flushProperties()));
+    }
+}
+
+void DBusInterface::invalidateProperty(const QString &interface, const QString &property)
+{
+    if (m_changedProperties.value(interface).contains(property))
+    {
+        m_changedProperties[interface].remove(property);
+    }
+
+    m_invalidatedProperties[interface].insert(property);
+
+    if (!m_flushScheduled)
+    {
+        m_flushScheduled = true;
+
+        QTimer::singleShot(0, this, SLOT(flushProperties()));
+    }
+}
+
+void DBusInterface::flushProperties()
+{
+    m_flushScheduled = false;
+
+    QMap<QString, QSet<QString> >::const_iterator invalidatedIterator;
+
+    for (invalidatedIterator = m_invalidatedProperties.constBegin(); invalidatedIterator != m_invalidatedProperties.constEnd(); ++invalidatedIterator)
+    {
+        QObject *adaptor = m_adaptors.value(invalidatedIterator.key());
+
+        if (!adaptor)
+        {
+            continue;
+        }
+
+        foreach (const QString &property, invalidatedIterator.value())
+        {
+            m_changedProperties[invalidatedIterator.key()][property] = adaptor->property(property.toLatin1().constData());
+        }
+    }
+
+    m_invalidatedProperties.clear();
+
+    QMap<QString, QVariantMap>::const_iterator changedIterator;
+
+    for (changedIterator = m_changedProperties.constBegin(); changedIterator != m_changedProperties.constEnd(); ++changedIterator)
+    {
+        QVariantMap properties;
+        QVariantMap::const_iterator iterator;
+
+        for (iterator = changedIterator.value().constBegin(); iterator != changedIterator.value().constEnd(); ++iterator)
+        {
+            if (!m_properties[changedIterator.key()].contains(iterator.key()) || m_properties[changedIterator.key()][iterator.key()] == iterator.value())
+            {
+                m_properties[changedIterator.key()][iterator.key()] = iterator.value();
+
+                Instrumentation::count("DBusInterface::suppressedProperties");
+
+                continue;
+            }
+
+            m_properties[changedIterator.key()][iterator.key()] = iterator.value();
+
+            properties[iterator.key()] = iterator.value();
+        }
+
+        if (properties.isEmpty())
+        {
+            Instrumentation::count("DBusInterface::suppressedMessages");
+
+            continue;
+        }
+
+        QVariantList arguments;
+        arguments << changedIterator.key();
+        arguments << properties;
+        arguments << QStringList();
+
+        QDBusMessage message = QDBusMessage::createSignal("/org/mpris/MediaPlayer2", "org.freedesktop.DBus.Properties", "PropertiesChanged");
+        message.setArguments(arguments);
+
+        QDBusConnection::sessionBus().send(message);
 
-    QDBusMessage message = QDBusMessage::createSignal("/org/mpris/MediaPlayer2", "org.freedesktop.DBus.Properties", "PropertiesChanged");
-    message.setArguments(arguments);
+        Instrumentation::count("DBusInterface::sentMessages");
+        Instrumentation::count("DBusInterface::sentProperties", properties.count());
+    }
 
-    QDBusConnection::sessionBus().send(message);
+    m_changedProperties.clear();
 }
 
 }
@@ -21,7 +21,9 @@
 #ifndef MINIPLAYERDBUSINTERFACE
 #define MINIPLAYERDBUSINTERFACE
 
+#include <QtCore/QSet>
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
 #include <QtCore/QVariantMap>
 
 namespace MiniPlayer
@@ -37,10 +39,22 @@ class DBusInterface : public QObject
         explicit DBusInterface(Applet *applet);
         ~DBusInterface();
 
-        static void updateProperties(const QString &interface, const QVariantMap &properties);
+        void updateProperties(const QString &interface, const QVariantMap &properties);
+        void invalidateProperty(const QString &interface, const QString &property);
+
+    protected:
+        void registerAdaptor(QObject *adaptor, const QStringList &properties = QStringList());
+
+    protected slots:
+        void flushProperties();
 
     private:
+        QMap<QString, QObject*> m_adaptors;
+        QMap<QString, QVariantMap> m_properties;
+        QMap<QString, QVariantMap> m_changedProperties;
+        QMap<QString, QSet<QString> > m_invalidatedProperties;
         QString m_instance;
+        bool m_flushScheduled;
 };
 
 }
@@ -32,22 +32,11 @@ namespace MiniPlayer
 DBusPlayerAdaptor::DBusPlayerAdaptor(QObject *parent, Player *player) : QDBusAbstractAdaptor(parent),
     m_player(player)
 {
-    m_properties["PlaybackStatus"] = PlaybackStatus();
-    m_properties["LoopStatus"] = LoopStatus();
-    m_properties["Shuffle"] = Shuffle();
-    m_properties["Metadata"] = Metadata();
-    m_properties["Volume"] = Volume();
-    m_properties["CanGoNext"] = CanGoNext();
-    m_properties["CanGoPrevious"] = CanGoPrevious();
-    m_properties["CanPlay"] = CanPlay();
-    m_properties["CanPause"] = CanPause();
-    m_properties["CanSeek"] = CanSeek();
-
     connect(m_player, SIGNAL(stateChanged(PlayerState)), this, SLOT(updateProperties()));
     connect(m_player, SIGNAL(playbackModeChanged(PlaybackMode)), this, SLOT(updateProperties()));
     connect(m_player, SIGNAL(volumeChanged(int)), this, SLOT(updateProperties()));
     connect(m_player, SIGNAL(trackAdded(int)), this, SLOT(updateProperties()));
-    connect(m_player, SIGNAL(trackRemoved(int)), this, SLOT(updateProperties()));
+    connect(m_player, SIGNAL(trackRemoved(int,int)), this, SLOT(updateProperties()));
     connect(m_player, SIGNAL(playlistChanged()), this, SLOT(updateProperties()));
     connect(m_player, SIGNAL(seekableChanged(bool)), this, SLOT(updateProperties()));
     connect(m_player, SIGNAL(metaDataChanged()), this, SLOT(emitMetaDataChanged()));
@@ -92,7 +81,7 @@ void DBusPlayerAdaptor::Seek(qint64 offset) const
 
 void DBusPlayerAdaptor::SetPosition(const QDBusObjectPath &trackId, qint64 position) const
 {
-    if (m_player->playlist() && QString("/track_%1").arg(m_player->playlist()->currentTrack()) == trackId.path())
+    if (m_player->playlist() && QString("/track_%1").arg(m_player->playlist()->trackId(m_player->playlist()->currentTrack())) == trackId.path())
     {
         m_player->setPosition(position / 1000);
     }
@@ -146,81 +135,21 @@ void DBusPlayerAdaptor::setVolume(double volume) const
 
 void DBusPlayerAdaptor::updateProperties()
 {
-    QVariantMap properties;
-
-    if (m_properties["PlaybackStatus"] != PlaybackStatus())
-    {
-        properties["PlaybackStatus"] = PlaybackStatus();
-    }
-
-    if (m_properties["LoopStatus"] != LoopStatus())
-    {
-        properties["LoopStatus"] = LoopStatus();
-    }
-
-    if (m_properties["Shuffle"] != Shuffle())
-    {
-        properties["Shuffle"] = Shuffle();
-    }
-
-    if (m_properties["Volume"] != Volume())
-    {
-        properties["Volume"] = Volume();
-    }
-
-    if (m_properties["CanGoNext"] != CanGoNext())
-    {
-        properties["CanGoNext"] = CanGoNext();
-    }
-
-    if (m_properties["CanGoPrevious"] != CanGoPrevious())
-    {
-        properties["CanGoPrevious"] = CanGoPrevious();
-    }
-
-    if (m_properties["CanPlay"] != CanPlay())
-    {
-        properties["CanPlay"] = CanPlay();
-    }
-
-    if (m_properties["CanPause"] != CanPause())
-    {
-        properties["CanPause"] = CanPause();
-    }
-
-    if (m_properties["CanSeek"] != CanSeek())
-    {
-        properties["CanSeek"] = CanSeek();
-    }
-
-    if (properties.isEmpty())
-    {
-        return;
-    }
-
-    QVariantMap::iterator iterator;
-
-    for (iterator = properties.begin(); iterator != properties.end(); ++iterator)
-    {
-        m_properties[iterator.key()] = iterator.value();
-    }
-
-    DBusInterface::updateProperties("org.mpris.MediaPlayer2.Player", properties);
+    DBusInterface *interface = static_cast<DBusInterface*>(parent());
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "PlaybackStatus");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "LoopStatus");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "Shuffle");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "Volume");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "CanGoNext");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "CanGoPrevious");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "CanPlay");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "CanPause");
+    interface->invalidateProperty("org.mpris.MediaPlayer2.Player", "CanSeek");
 }
 
 void DBusPlayerAdaptor::emitMetaDataChanged()
 {
-    if (m_properties["Metadata"] == Metadata())
-    {
-        return;
-    }
-
-    m_properties["Metadata"] = Metadata();
-
-    QVariantMap properties;
-    properties["Metadata"] = m_properties["Metadata"];
-
-    DBusInterface::updateProperties("org.mpris.MediaPlayer2.Player", properties);
+    static_cast<DBusInterface*>(parent())->invalidateProperty("org.mpris.MediaPlayer2.Player", "Metadata");
 }
 
 void DBusPlayerAdaptor::emitSeeked(qint64 position)
@@ -238,7 +167,7 @@ QVariantMap DBusPlayerAdaptor::Metadata() const
         return metaData;
     }
 
-    metaData["mpris:trackid"] = QString("/track_%1").arg(m_player->playlist()->currentTrack());
+    metaData["mpris:trackid"] = QString("/track_%1").arg(m_player->playlist()->trackId(m_player->playlist()->currentTrack()));
     metaData["mpris:length"] = (m_player->duration() * 1000);
     metaData["xesam:url"] = url.pathOrUrl();
     metaData["xesam:title"] = m_player->metaData(TitleKey);
@@ -92,7 +92,6 @@ class DBusPlayerAdaptor : public QDBusAbstractAdaptor
         void emitSeeked(qint64 position);
 
     private:
-        QVariantMap m_properties;
         Player *m_player;
 
     signals:
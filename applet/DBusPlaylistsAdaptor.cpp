@@ -33,6 +33,7 @@ DBusPlaylistsAdaptor::DBusPlaylistsAdaptor(QObject *parent, PlaylistManager *pla
     connect(m_playlistManager, SIGNAL(playlistRemoved(int)), this, SLOT(emitPlaylistCountChanged()));
     connect(m_playlistManager, SIGNAL(currentPlaylistChanged(int)), this, SLOT(emitActivePlaylistChanged()));
     connect(m_playlistManager, SIGNAL(playlistChanged(int)), this, SLOT(emitPlaylistChanged(int)));
+    connect(m_playlistManager, SIGNAL(modified()), this, SLOT(invalidateOrderings()));
 }
 
 void DBusPlaylistsAdaptor::ActivatePlaylist(const QDBusObjectPath &playlistId) const
@@ -44,7 +45,7 @@ void DBusPlaylistsAdaptor::ActivatePlaylist(const QDBusObjectPath &playlistId) c
 
     const int playlist = playlistId.path().mid(10).toInt();
 
-    if (playlist >= 0 && playlist < m_playlistManager->playlists().count())
+    if (m_playlistManager->playlist(playlist))
     {
         m_playlistManager->setCurrentPlaylist(playlist);
     }
@@ -52,22 +53,17 @@ void DBusPlaylistsAdaptor::ActivatePlaylist(const QDBusObjectPath &playlistId) c
 
 void DBusPlaylistsAdaptor::emitPlaylistCountChanged()
 {
-    QVariantMap properties;
-    properties["PlaylistCount"] = PlaylistCount();
-
-    DBusInterface::updateProperties("org.mpris.MediaPlayer2.Playlists", properties);
+    static_cast<DBusInterface*>(parent())->invalidateProperty("org.mpris.MediaPlayer2.Playlists", "PlaylistCount");
 }
 
 void DBusPlaylistsAdaptor::emitActivePlaylistChanged()
 {
-    QVariantMap properties;
-    properties["ActivePlaylist"] = ActivePlaylist();
-
-    DBusInterface::updateProperties("org.mpris.MediaPlayer2.Playlists", properties);
+    static_cast<DBusInterface*>(parent())->invalidateProperty("org.mpris.MediaPlayer2.Playlists", "ActivePlaylist");
 }
 
-void DBusPlaylistsAdaptor::emitPlaylistChanged(int id)
+void DBusPlaylistsAdaptor::emitPlaylistChanged(int position)
 {
+    const int id = m_playlistManager->playlists().value(position, -1);
     PlaylistModel *changedPlaylist = m_playlistManager->playlist(id);
 
     if (!changedPlaylist)
@@ -102,11 +98,51 @@ QVariantMap DBusPlaylistsAdaptor::ActivePlaylist() const
 
 QList<QVariantMap> DBusPlaylistsAdaptor::GetPlaylists(int index, int maxCount, QString order, bool reverseOrder) const
 {
-    QList<QVariantMap> reuestedPlaylists;
-    QList<int> sortedPlaylists;
+    QList<QVariantMap> requestedPlaylists;
+    const QList<int> &sortedPlaylists = orderedPlaylists(order);
+    const int count = sortedPlaylists.count();
+
+    if (index < 0)
+    {
+        index = 0;
+    }
+
+    if (index >= count)
+    {
+        return requestedPlaylists;
+    }
+
+    const int end = ((maxCount < 0)?count:qMin(count, (index + maxCount)));
+
+    requestedPlaylists.reserve(end - index);
+
+    for (int i = index; i < end; ++i)
+    {
+        const int id = sortedPlaylists.at(reverseOrder?(count - i - 1):i);
+        PlaylistModel *playlist = m_playlistManager->playlist(id);
+        QVariantMap playlistData;
+        playlistData["Id"] = qVariantFromValue(QDBusObjectPath(QString("/playlist_%1").arg(id)));
+        playlistData["Name"] = (playlist?playlist->title():QString());
+
+        requestedPlaylists.append(playlistData);
+    }
+
+    return requestedPlaylists;
+}
+
+const QList<int>& DBusPlaylistsAdaptor::orderedPlaylists(const QString &order) const
+{
+    const QString key = (Orderings().contains(order)?order:QString("UserDefined"));
+
+    if (m_orderings.contains(key))
+    {
+        return m_orderings[key];
+    }
+
     const QList<int> playlists = m_playlistManager->playlists();
+    QList<int> &sortedPlaylists = m_orderings[key];
 
-    if (order == "Alphabetical")
+    if (key == "Alphabetical")
     {
         QMultiMap<QString, int> alphabeticalMap;
 
@@ -114,86 +150,41 @@ QList<QVariantMap> DBusPlaylistsAdaptor::GetPlaylists(int index, int maxCount, Q
         {
             PlaylistModel *playlist = m_playlistManager->playlist(playlists.at(i));
 
-            alphabeticalMap.insert((playlist?playlist->title():QString()), i);
+            alphabeticalMap.insert((playlist?playlist->title():QString()), playlists.at(i));
         }
 
         sortedPlaylists = alphabeticalMap.values();
     }
-    else if (order == "CreationDate" || order == "ModifiedDate" || order == "LastPlayDate")
+    else if (key == "CreationDate" || key == "ModifiedDate" || key == "LastPlayDate")
     {
         QMultiMap<QDateTime, int> datesMap;
 
-        if (order == "CreationDate")
+        for (int i = 0; i < playlists.count(); ++i)
         {
-            for (int i = 0; i < playlists.count(); ++i)
-            {
-                PlaylistModel *playlist = m_playlistManager->playlist(playlists.at(i));
+            PlaylistModel *playlist = m_playlistManager->playlist(playlists.at(i));
+            QDateTime date;
 
-                datesMap.insert((playlist?playlist->creationDate():QDateTime()), i);
-            }
-        }
-        else if (order == "ModifiedDate")
-        {
-            for (int i = 0; i < playlists.count(); ++i)
+            if (playlist)
             {
-                PlaylistModel *playlist = m_playlistManager->playlist(playlists.at(i));
-
-                datesMap.insert((playlist?playlist->modificationDate():QDateTime()), i);
+                date = ((key == "CreationDate")?playlist->creationDate():((key == "ModifiedDate")?playlist->modificationDate():playlist->lastPlayedDate()));
             }
-        }
-        else
-        {
-            for (int i = 0; i < playlists.count(); ++i)
-            {
-                PlaylistModel *playlist = m_playlistManager->playlist(playlists.at(i));
 
-                datesMap.insert((playlist?playlist->lastPlayedDate():QDateTime()), i);
-            }
+            datesMap.insert(date, playlists.at(i));
         }
 
         sortedPlaylists = datesMap.values();
     }
     else
     {
-        for (int i = 0; i < playlists.count(); ++i)
-        {
-            sortedPlaylists.append(i);
-        }
-    }
-
-    if (index < 0 || index >= sortedPlaylists.count())
-    {
-        index = 0;
-    }
-
-    if (maxCount < 0 || maxCount >= sortedPlaylists.count())
-    {
-        maxCount = sortedPlaylists.count();
-    }
-
-    if (reverseOrder)
-    {
-        QList<int> reversedPlaylists;
-
-        for (int i = (sortedPlaylists.count() - 1); i >= 0; --i)
-        {
-            reversedPlaylists.append(sortedPlaylists.at(i));
-        }
-
-        sortedPlaylists = reversedPlaylists;
+        sortedPlaylists = playlists;
     }
 
-    for (int i = index; i < maxCount; ++i)
-    {
-        PlaylistModel *playlist = m_playlistManager->playlist(playlists.at(i));
-        QVariantMap playlistData;
-        playlistData["Id"] = qVariantFromValue(QDBusObjectPath(QString("/playlist_%1").arg(sortedPlaylists.at(i))));
-        playlistData["Name"] = (playlist?playlist->title():QString());
-
-        reuestedPlaylists.append(playlistData);
-    }
+    return sortedPlaylists;
+}
 
-    return reuestedPlaylists;
+void DBusPlaylistsAdaptor::invalidateOrderings()
+{
+    m_orderings.clear();
 }
 
 QStringList DBusPlaylistsAdaptor::Orderings() const
@@ -51,13 +51,18 @@ class DBusPlaylistsAdaptor : public QDBusAbstractAdaptor
     public slots:
         void ActivatePlaylist(const QDBusObjectPath &playlistId) const;
 
+    protected:
+        const QList<int>& orderedPlaylists(const QString &order) const;
+
     protected slots:
+        void invalidateOrderings();
         void emitPlaylistCountChanged();
         void emitActivePlaylistChanged();
-        void emitPlaylistChanged(int id);
+        void emitPlaylistChanged(int position);
 
     private:
         PlaylistManager *m_playlistManager;
+        mutable QMap<QString, QList<int> > m_orderings;
 
     signals:
         void PlaylistChanged(QVariantMap playlist);
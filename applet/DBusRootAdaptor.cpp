@@ -49,18 +49,12 @@ void DBusRootAdaptor::setFullscreen(bool enable) const
 
 void DBusRootAdaptor::emitFullscreenChanged()
 {
-    QVariantMap properties;
-    properties["Fullscreen"] = Fullscreen();
-
-    DBusInterface::updateProperties("org.mpris.MediaPlayer2", properties);
+    static_cast<DBusInterface*>(parent())->invalidateProperty("org.mpris.MediaPlayer2", "Fullscreen");
 }
 
 void DBusRootAdaptor::emitCanSetFullscreenChanged()
 {
-    QVariantMap properties;
-    properties["CanSetFullscreen"] = CanSetFullscreen();
-
-    DBusInterface::updateProperties("org.mpris.MediaPlayer2", properties);
+    static_cast<DBusInterface*>(parent())->invalidateProperty("org.mpris.MediaPlayer2", "CanSetFullscreen");
 }
 
 QStringList DBusRootAdaptor::SupportedUriSchemes() const
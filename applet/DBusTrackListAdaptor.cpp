@@ -23,23 +23,44 @@
 #include "PlaylistModel.h"
 #include "MetaDataManager.h"
 
+#include <QtCore/QTimerEvent>
+
 namespace MiniPlayer
 {
 
-DBusTrackListAdaptor::DBusTrackListAdaptor(QObject *parent, Player *player) : QDBusAbstractAdaptor(parent),
-    m_player(player)
+DBusTrackListAdaptor::DBusTrackListAdaptor(QObject *parent, Player *player, int trackLimit) : QDBusAbstractAdaptor(parent),
+    m_player(player),
+    m_tracksValid(false),
+    m_trackLimit(qMax(0, trackLimit)),
+    m_trackListReplacedTimer(0)
 {
-    connect(m_player, SIGNAL(playlistChanged()), this, SLOT(emitTrackListReplaced()));
+    connect(m_player, SIGNAL(playlistChanged()), this, SLOT(scheduleTrackListReplaced()));
+    connect(m_player, SIGNAL(currentTrackChanged()), this, SLOT(currentTrackChanged()));
+    connect(m_player, SIGNAL(trackAdded(int)), this, SLOT(invalidateTracks()));
+    connect(m_player, SIGNAL(trackRemoved(int,int)), this, SLOT(invalidateTracks()));
     connect(m_player, SIGNAL(trackAdded(int)), this, SLOT(emitTrackAdded(int)));
-    connect(m_player, SIGNAL(trackRemoved(int)), this, SLOT(emitTrackRemoved(int)));
+    connect(m_player, SIGNAL(trackRemoved(int,int)), this, SLOT(emitTrackRemoved(int,int)));
     connect(m_player, SIGNAL(trackChanged(int)), this, SLOT(emitTrackMetadataChanged(int)));
+    connect(MetaDataManager::instance(), SIGNAL(urlChanged(KUrl)), this, SLOT(invalidateMetaData(KUrl)));
+}
+
+void DBusTrackListAdaptor::timerEvent(QTimerEvent *event)
+{
+    killTimer(event->timerId());
+
+    if (event->timerId() == m_trackListReplacedTimer)
+    {
+        m_trackListReplacedTimer = 0;
+
+        emitTrackListReplaced();
+    }
 }
 
 void DBusTrackListAdaptor::AddTrack(const QString &uri, const QDBusObjectPath &afterTrack, bool setAsCurrent) const
 {
     if (m_player->playlist())
     {
-        m_player->playlist()->addTracks(KUrl::List(uri), (trackNumber(afterTrack.path()) + 1), (setAsCurrent?PlayReaction:NoReaction));
+        m_player->playlist()->addTracks(KUrl::List(uri), (trackRow(afterTrack) + 1), (setAsCurrent?PlayReaction:NoReaction));
     }
 }
 
@@ -47,38 +68,77 @@ void DBusTrackListAdaptor::RemoveTrack(const QDBusObjectPath &trackId) const
 {
     if (m_player->playlist())
     {
-        m_player->playlist()->removeTrack(trackNumber(trackId.path()));
+        m_player->playlist()->removeTrack(trackRow(trackId));
     }
 }
 
 void DBusTrackListAdaptor::GoTo(const QDBusObjectPath &trackId) const
 {
-    if (m_player->playlist())
+    const int track = trackRow(trackId);
+
+    if (m_player->playlist() && track >= 0)
+    {
+        m_player->playlist()->setCurrentTrack(track, PlayReaction);
+    }
+}
+
+void DBusTrackListAdaptor::scheduleTrackListReplaced()
+{
+    invalidateTracks();
+
+    m_metaData.clear();
+
+    if (!m_trackListReplacedTimer)
+    {
+        m_trackListReplacedTimer = startTimer(250);
+    }
+}
+
+void DBusTrackListAdaptor::currentTrackChanged()
+{
+    if (m_trackLimit > 0 && m_player->playlist() && m_player->playlist()->trackCount() > m_trackLimit)
     {
-        m_player->playlist()->setCurrentTrack(trackNumber(trackId.path()), PlayReaction);
+        invalidateTracks();
+
+        if (!m_trackListReplacedTimer)
+        {
+            m_trackListReplacedTimer = startTimer(250);
+        }
     }
 }
 
+void DBusTrackListAdaptor::invalidateTracks()
+{
+    m_tracksValid = false;
+}
+
+void DBusTrackListAdaptor::invalidateMetaData(const KUrl &url)
+{
+    m_metaData.remove(url);
+}
+
 void DBusTrackListAdaptor::emitTrackListReplaced()
 {
     const int track = (m_player->playlist()?m_player->playlist()->currentTrack():0);
 
-    emit TrackListReplaced(Tracks(), QDBusObjectPath(((track >= 0)?QString("/track_%1").arg(track):"/org/mpris/MediaPlayer2/TrackList/NoTrack")));
+    emit TrackListReplaced(Tracks(), QDBusObjectPath(((track >= 0)?trackPath(track):"/org/mpris/MediaPlayer2/TrackList/NoTrack")));
 }
 
 void DBusTrackListAdaptor::emitTrackAdded(int track)
 {
-    emit TrackAdded(metaData(track), QDBusObjectPath(((track > 0)?QString("/track_%1").arg(track - 1):"/org/mpris/MediaPlayer2/TrackList/NoTrack")));
+    emit TrackAdded(metaData(track), QDBusObjectPath(((track > 0)?trackPath(track - 1):"/org/mpris/MediaPlayer2/TrackList/NoTrack")));
 }
 
-void DBusTrackListAdaptor::emitTrackRemoved(int track)
+void DBusTrackListAdaptor::emitTrackRemoved(int track, int id)
 {
-    emit TrackRemoved(QDBusObjectPath(QString("/track_%1").arg(track)));
+    Q_UNUSED(track)
+
+    emit TrackRemoved(QDBusObjectPath(QString("/track_%1").arg(id)));
 }
 
 void DBusTrackListAdaptor::emitTrackMetadataChanged(int track)
 {
-    emit TrackMetadataChanged(QDBusObjectPath(QString("/track_%1").arg(track)), metaData(track));
+    emit TrackMetadataChanged(QDBusObjectPath(trackPath(track)), metaData(track));
 }
 
 QList<QVariantMap> DBusTrackListAdaptor::GetTracksMetadata(const QList<QDBusObjectPath> &trackIds) const
@@ -92,7 +152,7 @@ QList<QVariantMap> DBusTrackListAdaptor::GetTracksMetadata(const QList<QDBusObje
 
     for (int i = 0; i < trackIds.count(); ++i)
     {
-        const int track = trackNumber(trackIds.at(i).path());
+        const int track = trackRow(trackIds.at(i));
 
         if (track >= 0 && track < m_player->playlist()->trackCount())
         {
@@ -105,51 +165,85 @@ QList<QVariantMap> DBusTrackListAdaptor::GetTracksMetadata(const QList<QDBusObje
 
 QList<QDBusObjectPath> DBusTrackListAdaptor::Tracks() const
 {
-    QList<QDBusObjectPath> tracks;
+    if (m_tracksValid)
+    {
+        return m_tracks;
+    }
 
-    if (m_player->playlist())
+    m_tracks.clear();
+    m_tracksValid = true;
+
+    if (!m_player->playlist())
     {
-        for (int i = 0; i < m_player->playlist()->trackCount(); ++i)
-        {
-            tracks.append(QDBusObjectPath(QString("/track_%1").arg(i)));
-        }
+        return m_tracks;
+    }
+
+    const int count = m_player->playlist()->trackCount();
+    int first = 0;
+    int last = count;
+
+    if (m_trackLimit > 0 && count > m_trackLimit)
+    {
+        first = qBound(0, (m_player->playlist()->currentTrack() - (m_trackLimit / 2)), (count - m_trackLimit));
+        last = (first + m_trackLimit);
     }
 
-    return tracks;
+    m_tracks.reserve(last - first);
+
+    for (int i = first; i < last; ++i)
+    {
+        m_tracks.append(QDBusObjectPath(trackPath(i)));
+    }
+
+    return m_tracks;
 }
 
 QVariantMap DBusTrackListAdaptor::metaData(int track) const
 {
-    QVariantMap metaData;
-
-    if (!m_player->playlist() || track > m_player->playlist()->trackCount() || track < 0)
+    if (!m_player->playlist() || track >= m_player->playlist()->trackCount() || track < 0)
     {
-        return metaData;
+        return QVariantMap();
     }
 
     const KUrl url(m_player->playlist()->track(track));
 
-    metaData["mpris:trackid"] = QString("/track_%1").arg(track);
-    metaData["mpris:length"] = MetaDataManager::duration(url);
-    metaData["xesam:url"] = url.pathOrUrl();
-    metaData["xesam:title"] = MetaDataManager::metaData(url, TitleKey);
-    metaData["xesam:artist"] = MetaDataManager::metaData(url, ArtistKey);
-    metaData["xesam:album"] = MetaDataManager::metaData(url, AlbumKey);
-    metaData["xesam:genre"] = QStringList(MetaDataManager::metaData(url, GenreKey));
-    metaData["xesam:comment"] = QStringList(MetaDataManager::metaData(url, DescriptionKey));
-    metaData["xesam:trackNumber"] = MetaDataManager::metaData(url, TrackNumberKey);
+    if (!m_metaData.contains(url))
+    {
+        const Track data = MetaDataManager::track(url);
+        QVariantMap metaData;
+        metaData["mpris:length"] = data.duration;
+        metaData["xesam:url"] = url.pathOrUrl();
+        metaData["xesam:title"] = (data.keys.value(TitleKey).isEmpty()?MetaDataManager::urlToTitle(url):data.keys.value(TitleKey));
+        metaData["xesam:artist"] = (data.keys.value(ArtistKey).isEmpty()?i18n("Unknown artist"):data.keys.value(ArtistKey));
+        metaData["xesam:album"] = data.keys.value(AlbumKey);
+        metaData["xesam:genre"] = QStringList(data.keys.value(GenreKey));
+        metaData["xesam:comment"] = QStringList(data.keys.value(DescriptionKey));
+        metaData["xesam:trackNumber"] = data.keys.value(TrackNumberKey);
+
+        m_metaData[url] = metaData;
+    }
+
+    QVariantMap metaData = m_metaData[url];
+    metaData["mpris:trackid"] = trackPath(track);
 
     return metaData;
 }
 
-int DBusTrackListAdaptor::trackNumber(const QString &trackId)
+QString DBusTrackListAdaptor::trackPath(int track) const
 {
-    if (!trackId.startsWith("/track_") || trackId.length() < 8)
+    return QString("/track_%1").arg(m_player->playlist()?m_player->playlist()->trackId(track):-1);
+}
+
+int DBusTrackListAdaptor::trackRow(const QDBusObjectPath &trackId) const
+{
+    const QString path = trackId.path();
+
+    if (!m_player->playlist() || !path.startsWith("/track_") || path.length() < 8)
     {
         return -1;
     }
 
-    return trackId.mid(7).toInt();
+    return m_player->playlist()->trackRow(path.mid(7).toInt());
 }
 
 bool DBusTrackListAdaptor::CanEditTracks() const
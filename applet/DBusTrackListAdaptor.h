@@ -21,9 +21,13 @@
 #ifndef MINIPLAYERDBUSTRACKLISTADAPTOR
 #define MINIPLAYERDBUSTRACKLISTADAPTOR
 
+#include <QtCore/QMap>
+
 #include <QtDBus/QDBusObjectPath>
 #include <QtDBus/QDBusAbstractAdaptor>
 
+#include <KUrl>
+
 namespace MiniPlayer
 {
 
@@ -39,7 +43,7 @@ class DBusTrackListAdaptor : public QDBusAbstractAdaptor
     Q_PROPERTY(bool CanEditTracks READ CanEditTracks)
 
     public:
-        explicit DBusTrackListAdaptor(QObject *parent, Player *player);
+        explicit DBusTrackListAdaptor(QObject *parent, Player *player, int trackLimit = 0);
 
         QList<QVariantMap> GetTracksMetadata(const QList<QDBusObjectPath> &trackIds) const;
         QList<QDBusObjectPath> Tracks() const;
@@ -51,17 +55,30 @@ class DBusTrackListAdaptor : public QDBusAbstractAdaptor
         void GoTo(const QDBusObjectPath &trackId) const;
 
     protected:
+        void timerEvent(QTimerEvent *event);
         QVariantMap metaData(int track) const;
-        static int trackNumber(const QString &trackId);
+        QString trackPath(int track) const;
+        int trackRow(const QDBusObjectPath &trackId) const;
 
     protected slots:
+        void scheduleTrackListReplaced();
+        void currentTrackChanged();
+        void invalidateTracks();
+        void invalidateMetaData(const KUrl &url);
         void emitTrackListReplaced();
         void emitTrackAdded(int track);
-        void emitTrackRemoved(int track);
+        void emitTrackRemoved(int track, int id);
         void emitTrackMetadataChanged(int track);
 
     private:
         Player *m_player;
+        mutable QList<QDBusObjectPath> m_tracks;
+        mutable QMap<KUrl, QVariantMap> m_metaData;
+        mutable bool m_tracksValid;
+        int m_trackLimit;
+        int m_trackListReplacedTimer;
+
+    friend class DBusTrackListExtensionAdaptor;
 
     signals:
         void TrackListReplaced(QList<QDBusObjectPath> trackIds, QDBusObjectPath currentTrack);
@@ -0,0 +1,88 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "DBusTrackListExtensionAdaptor.h"
+#include "DBusTrackListAdaptor.h"
+#include "DBusInterface.h"
+#include "Player.h"
+#include "PlaylistModel.h"
+#include "MetaDataManager.h"
+
+#include <QtCore/QTimerEvent>
+
+namespace MiniPlayer
+{
+
+DBusTrackListExtensionAdaptor::DBusTrackListExtensionAdaptor(QObject *parent, DBusTrackListAdaptor *trackList) : QDBusAbstractAdaptor(parent),
+    m_trackList(trackList),
+    m_metadataResolutionTimer(0)
+{
+    connect(MetaDataManager::instance(), SIGNAL(resolutionProgressChanged()), this, SLOT(scheduleMetadataResolutionChanged()));
+}
+
+void DBusTrackListExtensionAdaptor::timerEvent(QTimerEvent *event)
+{
+    killTimer(event->timerId());
+
+    if (event->timerId() == m_metadataResolutionTimer)
+    {
+        m_metadataResolutionTimer = 0;
+
+        static_cast<DBusInterface*>(parent())->invalidateProperty("org.kde.plasma.miniplayer.TrackList", "MetadataResolution");
+    }
+}
+
+void DBusTrackListExtensionAdaptor::scheduleMetadataResolutionChanged()
+{
+    if (!m_metadataResolutionTimer)
+    {
+        m_metadataResolutionTimer = startTimer(1000);
+    }
+}
+
+QList<QVariantMap> DBusTrackListExtensionAdaptor::GetTracksMetadataRange(int first, int count) const
+{
+    QList<QVariantMap> metaData;
+    PlaylistModel *playlist = m_trackList->m_player->playlist();
+
+    if (!playlist)
+    {
+        return metaData;
+    }
+
+    first = qMax(0, first);
+
+    const int trackCount = playlist->trackCount();
+    const int last = ((count < 0 || count > (trackCount - first))?trackCount:(first + count));
+
+    for (int i = first; i < last; ++i)
+    {
+        metaData.append(m_trackList->metaData(i));
+    }
+
+    return metaData;
+}
+
+QVariantMap DBusTrackListExtensionAdaptor::MetadataResolution() const
+{
+    return MetaDataManager::resolutionProgress();
+}
+
+}
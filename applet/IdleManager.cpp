@@ -0,0 +1,136 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+
+#include "IdleManager.h"
+#include "Instrumentation.h"
+
+#include <QtCore/QTimerEvent>
+#include <QtCore/QCoreApplication>
+
+namespace MiniPlayer
+{
+
+IdleManager* IdleManager::m_instance = NULL;
+
+IdleManager::IdleManager(QObject *parent) : QObject(parent),
+    m_activityTimer(0),
+    m_isHidden(false),
+    m_isIdle(true)
+{
+}
+
+void IdleManager::createInstance()
+{
+    if (!m_instance)
+    {
+        m_instance = new IdleManager(QCoreApplication::instance());
+    }
+}
+
+void IdleManager::timerEvent(QTimerEvent *event)
+{
+    Instrumentation::recordWakeup("IdleManager");
+
+    killTimer(event->timerId());
+
+    m_activityTimer = 0;
+
+    updateState();
+}
+
+void IdleManager::notifyActivity()
+{
+    if (m_activityTimer)
+    {
+        killTimer(m_activityTimer);
+    }
+
+    m_activityTimer = startTimer(5000);
+
+    updateState();
+}
+
+void IdleManager::setPlayerState(PlayerState state)
+{
+    QObject *client = sender();
+
+    watchClient(client);
+
+    m_playerStates[client] = state;
+
+    updateState();
+}
+
+void IdleManager::setHidden(QObject *client, bool hidden)
+{
+    watchClient(client);
+
+    m_hiddenStates[client] = hidden;
+
+    updateState();
+}
+
+void IdleManager::watchClient(QObject *client)
+{
+    if (client && !m_playerStates.contains(client) && !m_hiddenStates.contains(client))
+    {
+        connect(client, SIGNAL(destroyed(QObject*)), this, SLOT(removeClient(QObject*)));
+    }
+}
+
+void IdleManager::removeClient(QObject *client)
+{
+    m_playerStates.remove(client);
+    m_hiddenStates.remove(client);
+
+    updateState();
+}
+
+void IdleManager::updateState()
+{
+    m_isHidden = (!m_hiddenStates.isEmpty() && !m_hiddenStates.values().contains(false));
+
+    const bool idle = (!m_activityTimer && (m_isHidden || !m_playerStates.values().contains(PlayingState)));
+
+    if (idle != m_isIdle)
+    {
+        m_isIdle = idle;
+
+        emit idleChanged(idle);
+    }
+}
+
+IdleManager* IdleManager::instance()
+{
+    return m_instance;
+}
+
+bool IdleManager::isIdle()
+{
+    return (m_instance && m_instance->m_isIdle);
+}
+
+bool IdleManager::isHidden()
+{
+    return (m_instance && m_instance->m_isHidden);
+}
+
+}
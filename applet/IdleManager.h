@@ -0,0 +1,74 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+
+#ifndef MINIPLAYERIDLEMANAGER_HEADER
+#define MINIPLAYERIDLEMANAGER_HEADER
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+
+#include "Constants.h"
+
+namespace MiniPlayer
+{
+
+class IdleManager : public QObject
+{
+    Q_OBJECT
+
+    public:
+        static void createInstance();
+        static IdleManager* instance();
+        static bool isIdle();
+        static bool isHidden();
+
+        void setHidden(QObject *client, bool hidden);
+
+    public slots:
+        void notifyActivity();
+        void setPlayerState(PlayerState state);
+
+    protected:
+        explicit IdleManager(QObject *parent);
+
+        void timerEvent(QTimerEvent *event);
+        void watchClient(QObject *client);
+        void updateState();
+
+    protected slots:
+        void removeClient(QObject *client);
+
+    private:
+        QHash<QObject*, PlayerState> m_playerStates;
+        QHash<QObject*, bool> m_hiddenStates;
+        int m_activityTimer;
+        bool m_isHidden;
+        bool m_isIdle;
+
+        static IdleManager *m_instance;
+
+    signals:
+        void idleChanged(bool idle);
+};
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+
+#include "Instrumentation.h"
+
+#include <QtCore/QStringList>
+
+namespace MiniPlayer
+{
+
+QHash<QByteArray, Histogram> Instrumentation::m_histograms;
+QHash<QByteArray, qint64> Instrumentation::m_wakeups;
+QHash<QByteArray, qint64> Instrumentation::m_counters;
+QElapsedTimer Instrumentation::m_wakeupsTimer;
+bool Instrumentation::m_forced = !qgetenv("MINIPLAYER_INSTRUMENTATION").isEmpty();
+bool Instrumentation::m_enabled = Instrumentation::m_forced;
+
+void Instrumentation::setEnabled(bool enabled)
+{
+    enabled = (enabled || m_forced);
+
+    if (enabled && !m_enabled)
+    {
+        m_wakeups.clear();
+        m_wakeupsTimer.start();
+    }
+
+    m_enabled = enabled;
+}
+
+void Instrumentation::record(const char *probe, qint64 duration)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    Histogram &histogram = m_histograms[QByteArray(probe)];
+    int bucket = 0;
+
+    for (qint64 value = qMax(duration, (qint64) 0); value > 1 && bucket < (histogram.buckets.count() - 1); value >>= 1)
+    {
+        ++bucket;
+    }
+
+    ++histogram.count;
+    ++histogram.buckets[bucket];
+
+    histogram.total += duration;
+    histogram.maximum = qMax(histogram.maximum, duration);
+}
+
+void Instrumentation::recordWakeup(const char *source)
+{
+    if (m_enabled)
+    {
+        ++m_wakeups[QByteArray(source)];
+    }
+}
+
+void Instrumentation::count(const char *counter, qint64 value)
+{
+    if (m_enabled)
+    {
+        m_counters[QByteArray(counter)] += value;
+    }
+}
+
+void Instrumentation::reset()
+{
+    m_histograms.clear();
+    m_wakeups.clear();
+    m_counters.clear();
+    m_wakeupsTimer.start();
+}
+
+QVariantMap Instrumentation::statistics()
+{
+    QVariantMap statistics;
+    QHash<QByteArray, Histogram>::const_iterator iterator;
+
+    for (iterator = m_histograms.constBegin(); iterator != m_histograms.constEnd(); ++iterator)
+    {
+        QVariantList buckets;
+
+        for (int i = 0; i < iterator.value().buckets.count(); ++i)
+        {
+            buckets.append(iterator.value().buckets.at(i));
+        }
+
+        QVariantMap probe;
+        probe["count"] = iterator.value().count;
+        probe["total"] = iterator.value().total;
+        probe["maximum"] = iterator.value().maximum;
+        probe["buckets"] = buckets;
+
+        statistics[QString::fromLatin1(iterator.key())] = probe;
+    }
+
+    QVariantMap wakeups;
+    QHash<QByteArray, qint64>::const_iterator wakeupsIterator;
+
+    for (wakeupsIterator = m_wakeups.constBegin(); wakeupsIterator != m_wakeups.constEnd(); ++wakeupsIterator)
+    {
+        wakeups[QString::fromLatin1(wakeupsIterator.key())] = wakeupsIterator.value();
+    }
+
+    statistics["wakeups"] = wakeups;
+    statistics["wakeupsPeriod"] = (m_wakeupsTimer.isValid()?m_wakeupsTimer.elapsed():0);
+
+    QVariantMap counters;
+    QHash<QByteArray, qint64>::const_iterator countersIterator;
+
+    for (countersIterator = m_counters.constBegin(); countersIterator != m_counters.constEnd(); ++countersIterator)
+    {
+        counters[QString::fromLatin1(countersIterator.key())] = countersIterator.value();
+    }
+
+    statistics["counters"] = counters;
+
+    return statistics;
+}
+
+QString Instrumentation::report()
+{
+    QStringList probes;
+    QHash<QByteArray, Histogram>::const_iterator iterator;
+
+    for (iterator = m_histograms.constBegin(); iterator != m_histograms.constEnd(); ++iterator)
+    {
+        const Histogram &histogram = iterator.value();
+        QString line = QString("%1: count %2, total %3 us, mean %4 us, max %5 us").arg(QString::fromLatin1(iterator.key())).arg(histogram.count).arg(histogram.total).arg(histogram.count?(histogram.total / histogram.count):0).arg(histogram.maximum);
+
+        for (int i = 0; i < histogram.buckets.count(); ++i)
+        {
+            if (histogram.buckets.at(i) > 0)
+            {
+                line.append(QString("\n    < %1 us: %2").arg(((qint64) 1) << (i + 1)).arg(histogram.buckets.at(i)));
+            }
+        }
+
+        probes.append(line);
+    }
+
+    probes.sort();
+
+    const qreal period = (m_wakeupsTimer.isValid()?qMax((qreal) 1, (m_wakeupsTimer.elapsed() / (qreal) 1000)):1);
+    QStringList wakeups;
+    qint64 total = 0;
+    QHash<QByteArray, qint64>::const_iterator wakeupsIterator;
+
+    for (wakeupsIterator = m_wakeups.constBegin(); wakeupsIterator != m_wakeups.constEnd(); ++wakeupsIterator)
+    {
+        wakeups.append(QString("    %1: %2 (%3/s)").arg(QString::fromLatin1(wakeupsIterator.key())).arg(wakeupsIterator.value()).arg((wakeupsIterator.value() / period), 0, 'f', 2));
+
+        total += wakeupsIterator.value();
+    }
+
+    wakeups.sort();
+    wakeups.prepend(QString("Wakeups: %1 (%2/s)").arg(total).arg((total / period), 0, 'f', 2));
+
+    probes.append(wakeups.join("\n"));
+
+    if (!m_counters.isEmpty())
+    {
+        QStringList counters;
+        QHash<QByteArray, qint64>::const_iterator countersIterator;
+
+        for (countersIterator = m_counters.constBegin(); countersIterator != m_counters.constEnd(); ++countersIterator)
+        {
+            counters.append(QString("    %1: %2").arg(QString::fromLatin1(countersIterator.key())).arg(countersIterator.value()));
+        }
+
+        counters.sort();
+        counters.prepend(QString("Counters:"));
+
+        probes.append(counters.join("\n"));
+    }
+
+    return probes.join("\n");
+}
+
+}
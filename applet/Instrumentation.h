@@ -0,0 +1,95 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+
+#ifndef MINIPLAYERINSTRUMENTATION_HEADER
+#define MINIPLAYERINSTRUMENTATION_HEADER
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtCore/QVariantMap>
+#include <QtCore/QElapsedTimer>
+
+namespace MiniPlayer
+{
+
+struct Histogram
+{
+    Histogram() : count(0), total(0), maximum(0), buckets(24, 0) {}
+
+    qint64 count;
+    qint64 total;
+    qint64 maximum;
+    QVector<qint64> buckets;
+};
+
+class Instrumentation
+{
+    public:
+        static void setEnabled(bool enabled);
+        static void record(const char *probe, qint64 duration);
+        static void recordWakeup(const char *source);
+        static void count(const char *counter, qint64 value = 1);
+        static void reset();
+        static QVariantMap statistics();
+        static QString report();
+
+        static inline bool isEnabled()
+        {
+            return m_enabled;
+        }
+
+    private:
+        static QHash<QByteArray, Histogram> m_histograms;
+        static QHash<QByteArray, qint64> m_wakeups;
+        static QHash<QByteArray, qint64> m_counters;
+        static QElapsedTimer m_wakeupsTimer;
+        static bool m_forced;
+        static bool m_enabled;
+};
+
+class ScopedTimer
+{
+    public:
+        explicit ScopedTimer(const char *probe) : m_probe(probe), m_enabled(Instrumentation::isEnabled())
+        {
+            if (m_enabled)
+            {
+                m_timer.start();
+            }
+        }
+
+        ~ScopedTimer()
+        {
+            if (m_enabled)
+            {
+                Instrumentation::record(m_probe, (m_timer.nsecsElapsed() / 1000));
+            }
+        }
+
+    private:
+        QElapsedTimer m_timer;
+        const char *m_probe;
+        bool m_enabled;
+};
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+
+#include "LoudnessAnalyzer.h"
+
+#include <cmath>
+
+namespace MiniPlayer
+{
+
+const qreal LoudnessAnalyzer::ReferenceLoudness = -18;
+
+LoudnessAnalyzer::LoudnessAnalyzer(int sampleRate)
+{
+    reset(sampleRate);
+}
+
+void LoudnessAnalyzer::reset(int sampleRate)
+{
+    m_sampleRate = qMax(8000, sampleRate);
+    m_blockSize = (m_sampleRate / 10);
+    m_blockSamples = 0;
+    m_blockEnergy = 0;
+    m_subBlock = 0;
+    m_subBlocks = 0;
+    m_samples = 0;
+    m_peak = 0;
+    m_blocks.clear();
+    m_state.fill(0, ((Phonon::AudioDataOutput::SubwooferChannel + 1) * 4));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        m_energy[i] = 0;
+    }
+
+    double k = tan(M_PI * 1681.974450955533 / m_sampleRate);
+    double q = 0.7071752369554196;
+    const double vh = pow(10.0, (3.999843853973347 / 20));
+    const double vb = pow(vh, 0.4996667741545416);
+    double a0 = (1 + (k / q) + (k * k));
+
+    m_shelvingFilter.b[0] = ((vh + (vb * k / q) + (k * k)) / a0);
+    m_shelvingFilter.b[1] = ((2 * ((k * k) - vh)) / a0);
+    m_shelvingFilter.b[2] = ((vh - (vb * k / q) + (k * k)) / a0);
+    m_shelvingFilter.a[0] = 1;
+    m_shelvingFilter.a[1] = ((2 * ((k * k) - 1)) / a0);
+    m_shelvingFilter.a[2] = ((1 - (k / q) + (k * k)) / a0);
+
+    k = tan(M_PI * 38.13547087602444 / m_sampleRate);
+    q = 0.5003270373238773;
+    a0 = (1 + (k / q) + (k * k));
+
+    m_highPassFilter.b[0] = 1;
+    m_highPassFilter.b[1] = -2;
+    m_highPassFilter.b[2] = 1;
+    m_highPassFilter.a[0] = 1;
+    m_highPassFilter.a[1] = ((2 * ((k * k) - 1)) / a0);
+    m_highPassFilter.a[2] = ((1 - (k / q) + (k * k)) / a0);
+}
+
+void LoudnessAnalyzer::process(const QMap<Phonon::AudioDataOutput::Channel, QVector<qint16> > &data)
+{
+    int frames = -1;
+    QMap<Phonon::AudioDataOutput::Channel, QVector<qint16> >::const_iterator iterator;
+
+    for (iterator = data.constBegin(); iterator != data.constEnd(); ++iterator)
+    {
+        frames = ((frames < 0)?iterator.value().count():qMin(frames, iterator.value().count()));
+    }
+
+    int offset = 0;
+
+    while (frames > 0 && offset < frames)
+    {
+        const int length = qMin((frames - offset), (m_blockSize - m_blockSamples));
+
+        for (iterator = data.constBegin(); iterator != data.constEnd(); ++iterator)
+        {
+            if (iterator.key() == Phonon::AudioDataOutput::SubwooferChannel)
+            {
+                continue;
+            }
+
+            processChannel(iterator.key(), (iterator.value().constData() + offset), length, ((iterator.key() == Phonon::AudioDataOutput::LeftSurroundChannel || iterator.key() == Phonon::AudioDataOutput::RightSurroundChannel)?1.41:1.0));
+        }
+
+        offset += length;
+        m_samples += length;
+        m_blockSamples += length;
+
+        if (m_blockSamples >= m_blockSize)
+        {
+            finishBlock();
+        }
+    }
+}
+
+void LoudnessAnalyzer::processChannel(int channel, const qint16 *input, int count, double weight)
+{
+    m_buffer.resize(count);
+
+    float *buffer = m_buffer.data();
+    float peak = m_peak;
+
+    for (int i = 0; i < count; ++i)
+    {
+        buffer[i] = (input[i] / 32768.0f);
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        peak = qMax(peak, fabsf(buffer[i]));
+    }
+
+    m_peak = peak;
+
+    double *state = (m_state.data() + (channel * 4));
+    double energy = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const double shelved = ((m_shelvingFilter.b[0] * buffer[i]) + state[0]);
+
+        state[0] = ((m_shelvingFilter.b[1] * buffer[i]) - (m_shelvingFilter.a[1] * shelved) + state[1]);
+        state[1] = ((m_shelvingFilter.b[2] * buffer[i]) - (m_shelvingFilter.a[2] * shelved));
+
+        const double filtered = ((m_highPassFilter.b[0] * shelved) + state[2]);
+
+        state[2] = ((m_highPassFilter.b[1] * shelved) - (m_highPassFilter.a[1] * filtered) + state[3]);
+        state[3] = ((m_highPassFilter.b[2] * shelved) - (m_highPassFilter.a[2] * filtered));
+
+        buffer[i] = filtered;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        energy += (buffer[i] * buffer[i]);
+    }
+
+    m_blockEnergy += (energy * weight);
+}
+
+void LoudnessAnalyzer::finishBlock()
+{
+    m_energy[m_subBlock] = (m_blockEnergy / m_blockSize);
+    m_subBlock = ((m_subBlock + 1) % 4);
+    m_blockEnergy = 0;
+    m_blockSamples = 0;
+
+    if (m_subBlocks < 4)
+    {
+        ++m_subBlocks;
+    }
+
+    if (m_subBlocks == 4)
+    {
+        m_blocks.append((m_energy[0] + m_energy[1] + m_energy[2] + m_energy[3]) / 4);
+    }
+}
+
+qint64 LoudnessAnalyzer::analyzedTime() const
+{
+    return ((m_samples * 1000) / m_sampleRate);
+}
+
+qreal LoudnessAnalyzer::loudness() const
+{
+    const double absoluteThreshold = pow(10.0, ((-70 + 0.691) / 10));
+    double energy = 0;
+    int count = 0;
+
+    for (int i = 0; i < m_blocks.count(); ++i)
+    {
+        if (m_blocks.at(i) > absoluteThreshold)
+        {
+            energy += m_blocks.at(i);
+
+            ++count;
+        }
+    }
+
+    if (count == 0)
+    {
+        return -70;
+    }
+
+    const double relativeThreshold = ((energy / count) * pow(10.0, -1.0));
+
+    energy = 0;
+    count = 0;
+
+    for (int i = 0; i < m_blocks.count(); ++i)
+    {
+        if (m_blocks.at(i) > absoluteThreshold && m_blocks.at(i) > relativeThreshold)
+        {
+            energy += m_blocks.at(i);
+
+            ++count;
+        }
+    }
+
+    if (count == 0)
+    {
+        return -70;
+    }
+
+    return (-0.691 + (10 * log10(energy / count)));
+}
+
+qreal LoudnessAnalyzer::gain() const
+{
+    return (ReferenceLoudness - loudness());
+}
+
+qreal LoudnessAnalyzer::peak() const
+{
+    return m_peak;
+}
+
+bool LoudnessAnalyzer::isValid() const
+{
+    return !m_blocks.isEmpty();
+}
+
+}
@@ -0,0 +1,77 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+
+#ifndef MINIPLAYERLOUDNESSANALYZER_HEADER
+#define MINIPLAYERLOUDNESSANALYZER_HEADER
+
+#include <QtCore/QMap>
+#include <QtCore/QVector>
+
+#include <Phonon/AudioDataOutput>
+
+namespace MiniPlayer
+{
+
+struct BiquadFilter
+{
+    double b[3];
+    double a[3];
+};
+
+class LoudnessAnalyzer
+{
+    public:
+        explicit LoudnessAnalyzer(int sampleRate = 44100);
+
+        void reset(int sampleRate);
+        void process(const QMap<Phonon::AudioDataOutput::Channel, QVector<qint16> > &data);
+        qint64 analyzedTime() const;
+        qreal loudness() const;
+        qreal gain() const;
+        qreal peak() const;
+        bool isValid() const;
+
+        static const qreal ReferenceLoudness;
+
+    protected:
+        void processChannel(int channel, const qint16 *input, int count, double weight);
+        void finishBlock();
+
+    private:
+        QVector<float> m_buffer;
+        QVector<double> m_blocks;
+        QVector<double> m_state;
+        BiquadFilter m_shelvingFilter;
+        BiquadFilter m_highPassFilter;
+        double m_energy[4];
+        double m_blockEnergy;
+        qint64 m_samples;
+        int m_sampleRate;
+        int m_blockSize;
+        int m_blockSamples;
+        int m_subBlock;
+        int m_subBlocks;
+        float m_peak;
+};
+
+}
+
+#endif
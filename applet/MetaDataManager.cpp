@@ -19,9 +19,15 @@
 ***********************************************************************************/
 
 #include "MetaDataManager.h"
+#include "Instrumentation.h"
+#include "IdleManager.h"
 
+#include <QtCore/QSet>
+#include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QTimerEvent>
+#include <QtCore/QCoreApplication>
 
 #include <KMimeType>
 
@@ -29,8 +35,14 @@ namespace MiniPlayer
 {
 
 QQueue<QPair<KUrl, int> > MetaDataManager::m_queue;
+QList<QPair<KUrl, int> > MetaDataManager::m_deferredQueue;
 QMap<KUrl, Track> MetaDataManager::m_tracks;
+QHash<QByteArray, KUrl> MetaDataManager::m_fingerprints;
+QHash<QByteArray, Track> MetaDataManager::m_orphanedTracks;
+QQueue<QByteArray> MetaDataManager::m_orphanedOrder;
 MetaDataManager* MetaDataManager::m_instance = NULL;
+int MetaDataManager::m_resolvedTracks = 0;
+int MetaDataManager::m_failedTracks = 0;
 
 MetaDataManager::MetaDataManager(QObject *parent) : QObject(parent),
     m_mediaObject(new Phonon::MediaObject(this)),
@@ -48,13 +60,18 @@ MetaDataManager::MetaDataManager(QObject *parent) : QObject(parent),
 
 void MetaDataManager::createInstance(QObject *parent)
 {
-    m_instance = new MetaDataManager(parent);
+    if (!m_instance)
+    {
+        m_instance = new MetaDataManager(parent?parent:QCoreApplication::instance());
+    }
 }
 
 void MetaDataManager::timerEvent(QTimerEvent *event)
 {
     Q_UNUSED(event)
 
+    Instrumentation::recordWakeup("MetaDataManager");
+
     killTimer(event->timerId());
 
     resolveMetaData();
@@ -62,6 +79,8 @@ void MetaDataManager::timerEvent(QTimerEvent *event)
 
 void MetaDataManager::resolveMetaData()
 {
+    ScopedTimer timer("MetaDataManager::resolveMetaData");
+
     QPair<KUrl, int> url;
 
     killTimer(m_resolveMedia);
@@ -81,10 +100,16 @@ void MetaDataManager::resolveMetaData()
             }
         }
 
+        readGain(m_mediaObject, track);
+
         m_mediaObject->stop();
 
         if (track.keys.contains(TitleKey) && !track.keys[TitleKey].isEmpty())
         {
+            ++m_resolvedTracks;
+
+            track.fingerprint = (m_fingerprint.isEmpty()?fingerprint(KUrl(m_mediaObject->currentSource().url())):m_fingerprint);
+
             setMetaData(m_mediaObject->currentSource().url(), track);
         }
         else if (m_attempts < 5)
@@ -113,6 +138,10 @@ void MetaDataManager::resolveMetaData()
                 track.keys[TitleKey] = path.simplified();
             }
 
+            ++m_failedTracks;
+
+            track.fingerprint = (m_fingerprint.isEmpty()?fingerprint(KUrl(m_mediaObject->currentSource().url())):m_fingerprint);
+
             setMetaData(m_mediaObject->currentSource().url(), track);
         }
     }
@@ -120,15 +149,49 @@ void MetaDataManager::resolveMetaData()
     m_mediaObject->deleteLater();
     m_mediaObject = new Phonon::MediaObject(this);
 
+    int fingerprints = 0;
+
     while (!m_queue.isEmpty())
     {
         url = m_queue.dequeue();
 
+        m_fingerprint.clear();
+
         if (!url.first.isValid() || !url.first.isLocalFile() || (m_tracks.contains(url.first) && m_tracks[url.first].duration > 0))
         {
             continue;
         }
 
+        if (url.second == 0 && (!m_fingerprints.isEmpty() || !m_orphanedTracks.isEmpty()))
+        {
+            if (fingerprints >= 50)
+            {
+                m_queue.prepend(url);
+
+                m_resolveMedia = startTimer(0);
+
+                emit resolutionProgressChanged();
+
+                return;
+            }
+
+            ++fingerprints;
+
+            m_fingerprint = fingerprint(url.first);
+
+            if (relinkTrack(url.first, m_fingerprint))
+            {
+                continue;
+            }
+        }
+
+        if (url.second > 0 && IdleManager::isIdle())
+        {
+            m_deferredQueue.append(url);
+
+            continue;
+        }
+
         m_attempts = url.second;
 
         m_mediaObject->setCurrentSource(Phonon::MediaSource(url.first));
@@ -136,10 +199,35 @@ void MetaDataManager::resolveMetaData()
 
         m_resolveMedia = startTimer(200 + (m_attempts * 100));
 
+        emit resolutionProgressChanged();
+
         return;
     }
 
     m_mediaObject->setCurrentSource(Phonon::MediaSource());
+
+    if (m_deferredQueue.isEmpty())
+    {
+        trimOrphanedTracks();
+    }
+
+    emit resolutionProgressChanged();
+}
+
+void MetaDataManager::idleChanged(bool idle)
+{
+    if (idle || m_deferredQueue.isEmpty())
+    {
+        return;
+    }
+
+    m_queue.append(m_deferredQueue);
+    m_deferredQueue.clear();
+
+    if (!m_mediaObject->currentSource().url().isValid())
+    {
+        resolveMetaData();
+    }
 }
 
 void MetaDataManager::resolveTracks(const KUrl::List &urls)
@@ -149,6 +237,12 @@ void MetaDataManager::resolveTracks(const KUrl::List &urls)
 
 void MetaDataManager::addTracks(const KUrl::List &urls)
 {
+    if (m_queue.isEmpty() && m_deferredQueue.isEmpty() && !m_mediaObject->currentSource().url().isValid())
+    {
+        m_resolvedTracks = 0;
+        m_failedTracks = 0;
+    }
+
     for (int i = (urls.count() - 1); i >= 0 ; --i)
     {
         m_queue.prepend(qMakePair(urls.value(i), 0));
@@ -207,7 +301,25 @@ void MetaDataManager::setMetaData(const KUrl &url, const Track &track, bool noti
         return;
     }
 
-    m_tracks[url] = track;
+    if (!track.hasGain && m_tracks.contains(url) && m_tracks[url].hasGain)
+    {
+        const Track previous = m_tracks[url];
+
+        m_tracks[url] = track;
+        m_tracks[url].gain = previous.gain;
+        m_tracks[url].peak = previous.peak;
+        m_tracks[url].hasGain = true;
+    }
+    else
+    {
+        m_tracks[url] = track;
+    }
+
+    if (!track.fingerprint.isEmpty())
+    {
+        m_fingerprints[track.fingerprint] = url;
+        m_orphanedTracks.remove(track.fingerprint);
+    }
 
     if (notify)
     {
@@ -215,6 +327,49 @@ void MetaDataManager::setMetaData(const KUrl &url, const Track &track, bool noti
     }
 }
 
+void MetaDataManager::setGain(const KUrl &url, qreal gain, qreal peak)
+{
+    if (!url.isValid())
+    {
+        return;
+    }
+
+    if (!m_tracks.contains(url))
+    {
+        m_tracks[url] = Track();
+    }
+
+    m_tracks[url].gain = gain;
+    m_tracks[url].peak = peak;
+    m_tracks[url].hasGain = true;
+
+    emit m_instance->urlChanged(url);
+}
+
+void MetaDataManager::readGain(const Phonon::MediaObject *mediaObject, Track &track)
+{
+    const QStringList gain = mediaObject->metaData("REPLAYGAIN_TRACK_GAIN");
+
+    if (gain.isEmpty())
+    {
+        return;
+    }
+
+    bool ok = false;
+    const qreal value = QString(gain.first()).remove("dB", Qt::CaseInsensitive).trimmed().toDouble(&ok);
+
+    if (!ok)
+    {
+        return;
+    }
+
+    const QStringList peak = mediaObject->metaData("REPLAYGAIN_TRACK_PEAK");
+
+    track.gain = value;
+    track.peak = (peak.isEmpty()?-1:qMax(0.0, peak.first().trimmed().toDouble()));
+    track.hasGain = true;
+}
+
 void MetaDataManager::removeMetaData(const KUrl &url)
 {
     QList<QPair<KUrl, int> >::iterator i;
@@ -227,7 +382,95 @@ void MetaDataManager::removeMetaData(const KUrl &url)
         }
     }
 
-    m_tracks.remove(url);
+    for (int i = (m_deferredQueue.count() - 1); i >= 0; --i)
+    {
+        if (m_deferredQueue.at(i).first == url)
+        {
+            m_deferredQueue.removeAt(i);
+        }
+    }
+
+    if (!m_tracks.contains(url))
+    {
+        return;
+    }
+
+    const Track track = m_tracks.take(url);
+
+    if (track.fingerprint.isEmpty() || m_fingerprints.value(track.fingerprint) != url)
+    {
+        return;
+    }
+
+    m_fingerprints.remove(track.fingerprint);
+
+    if (!m_orphanedTracks.contains(track.fingerprint))
+    {
+        m_orphanedOrder.enqueue(track.fingerprint);
+    }
+
+    m_orphanedTracks[track.fingerprint] = track;
+}
+
+void MetaDataManager::trimOrphanedTracks()
+{
+    while (m_orphanedTracks.count() > 1000 && !m_orphanedOrder.isEmpty())
+    {
+        m_orphanedTracks.remove(m_orphanedOrder.dequeue());
+    }
+
+    if (m_orphanedOrder.count() <= m_orphanedTracks.count())
+    {
+        return;
+    }
+
+    QQueue<QByteArray> order;
+    QSet<QByteArray> keys;
+
+    for (int i = (m_orphanedOrder.count() - 1); i >= 0; --i)
+    {
+        const QByteArray key = m_orphanedOrder.at(i);
+
+        if (m_orphanedTracks.contains(key) && !keys.contains(key))
+        {
+            keys.insert(key);
+
+            order.prepend(key);
+        }
+    }
+
+    m_orphanedOrder = order;
+}
+
+bool MetaDataManager::relinkTrack(const KUrl &url, const QByteArray &key)
+{
+    if (key.isEmpty())
+    {
+        return false;
+    }
+
+    Track track;
+
+    if (m_fingerprints.contains(key) && m_fingerprints[key] != url && m_tracks.contains(m_fingerprints[key]))
+    {
+        track = m_tracks[m_fingerprints[key]];
+    }
+    else if (m_orphanedTracks.contains(key))
+    {
+        track = m_orphanedTracks[key];
+    }
+    else
+    {
+        return false;
+    }
+
+    ++m_resolvedTracks;
+
+    Instrumentation::count("MetaDataManager::relinkedTracks");
+
+    setMetaData(url, track, true);
+
+    return true;
 }
 
 MetaDataManager* MetaDataManager::instance()
@@ -240,6 +483,21 @@ KUrl::List MetaDataManager::tracks()
     return m_tracks.keys();
 }
 
+Track MetaDataManager::track(const KUrl &url)
+{
+    return m_tracks.value(url);
+}
+
+QVariantMap MetaDataManager::resolutionProgress()
+{
+    QVariantMap progress;
+    progress["pending"] = (m_queue.count() + m_deferredQueue.count() + ((m_instance && m_instance->m_mediaObject->currentSource().url().isValid())?1:0));
+    progress["resolved"] = m_resolvedTracks;
+    progress["failed"] = m_failedTracks;
+
+    return progress;
+}
+
 QVariantMap MetaDataManager::metaData(const KUrl &url)
 {
     QVariantMap trackData;
@@ -283,6 +541,34 @@ QString MetaDataManager::metaData(const KUrl &url, MetaDataKey key, bool substit
     return QString();
 }
 
+QByteArray MetaDataManager::fingerprint(const KUrl &url)
+{
+    if (!url.isLocalFile())
+    {
+        return QByteArray();
+    }
+
+    QFile file(url.toLocalFile());
+
+    if (!file.open(QIODevice::ReadOnly) || file.size() < 1)
+    {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArray::number(file.size()));
+    hash.addData(file.read(65536));
+
+    if (file.size() > 65536)
+    {
+        file.seek(qMax(qint64(65536), (file.size() - 65536)));
+
+        hash.addData(file.read(65536));
+    }
+
+    return hash.result().toHex();
+}
+
 QString MetaDataManager::timeToString(qint64 time)
 {
     if (time < 1)
@@ -329,15 +615,15 @@ QString MetaDataManager::urlToTitle(const KUrl &url)
     return title;
 }
 
-KIcon MetaDataManager::icon(const KUrl &url)
+QIcon MetaDataManager::icon(const KUrl &url)
 {
     if (url.isValid())
     {
-        return KIcon(KMimeType::iconNameForUrl(url));
+        return QIcon::fromTheme(KMimeType::iconNameForUrl(url));
     }
     else
     {
-        return KIcon("application-x-zerosize");
+        return QIcon::fromTheme("application-x-zerosize");
     }
 }
 
@@ -351,6 +637,31 @@ qint64 MetaDataManager::duration(const KUrl &url)
     return -1;
 }
 
+qreal MetaDataManager::gain(const KUrl &url)
+{
+    if (m_tracks.contains(url))
+    {
+        return m_tracks[url].gain;
+    }
+
+    return 0;
+}
+
+qreal MetaDataManager::peak(const KUrl &url)
+{
+    if (m_tracks.contains(url))
+    {
+        return m_tracks[url].peak;
+    }
+
+    return -1;
+}
+
+bool MetaDataManager::hasGain(const KUrl &url)
+{
+    return (m_tracks.contains(url) && m_tracks[url].hasGain);
+}
+
 bool MetaDataManager::isAvailable(const KUrl &url, bool complete)
 {
     return (m_tracks.contains(url) && !metaData(url, TitleKey, false).isEmpty() && (!complete || (!metaData(url, TitleKey, false).isEmpty() && !m_tracks[url].duration > 0)));
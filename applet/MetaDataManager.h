@@ -21,10 +21,12 @@
 #ifndef MINIPLAYERMETADATAMANAGER_HEADER
 #define MINIPLAYERMETADATAMANAGER_HEADER
 
+#include <QtCore/QHash>
 #include <QtCore/QQueue>
 
+#include <QtGui/QIcon>
+
 #include <KUrl>
-#include <KIcon>
 #include <KLocale>
 
 #include <Phonon/MediaObject>
@@ -36,8 +38,14 @@ namespace MiniPlayer
 
 struct Track
 {
+    Track() : duration(-1), gain(0), peak(-1), hasGain(false) {}
+
     QMap<MetaDataKey, QString> keys;
+    QByteArray fingerprint;
     qint64 duration;
+    qreal gain;
+    qreal peak;
+    bool hasGain;
 };
 
 class MetaDataManager : public QObject
@@ -50,17 +58,28 @@ class MetaDataManager : public QObject
         static void setDuration(const KUrl &url, qint64 duration);
         static void setMetaData(const KUrl &url, MetaDataKey key, const QString &value);
         static void setMetaData(const KUrl &url, const Track &track);
+        static void setGain(const KUrl &url, qreal gain, qreal peak);
+        static void readGain(const Phonon::MediaObject *mediaObject, Track &track);
         static void removeMetaData(const KUrl &url);
         static MetaDataManager* instance();
         static KUrl::List tracks();
+        static Track track(const KUrl &url);
         static QVariantMap metaData(const KUrl &url);
+        static QVariantMap resolutionProgress();
         static QString metaData(const KUrl &url, MetaDataKey key, bool substitute = true);
         static QString timeToString(qint64 time);
+        static QByteArray fingerprint(const KUrl &url);
         static QString urlToTitle(const KUrl &url);
-        static KIcon icon(const KUrl &url);
+        static QIcon icon(const KUrl &url);
         static qint64 duration(const KUrl &url);
+        static qreal gain(const KUrl &url);
+        static qreal peak(const KUrl &url);
+        static bool hasGain(const KUrl &url);
         static bool isAvailable(const KUrl &url, bool complete = false);
 
+    public slots:
+        void idleChanged(bool idle);
+
     protected:
         explicit MetaDataManager(QObject *parent);
 
@@ -68,19 +87,29 @@ class MetaDataManager : public QObject
         void resolveMetaData();
         void addTracks(const KUrl::List &urls);
         void setMetaData(const KUrl &url, const Track &track, bool notify);
+        bool relinkTrack(const KUrl &url, const QByteArray &key);
+        static void trimOrphanedTracks();
 
     private:
         Phonon::MediaObject *m_mediaObject;
         QList<QPair<MetaDataKey, Phonon::MetaData> > m_keys;
+        QByteArray m_fingerprint;
         int m_resolveMedia;
         int m_attempts;
 
         static QQueue<QPair<KUrl, int> > m_queue;
+        static QList<QPair<KUrl, int> > m_deferredQueue;
         static QMap<KUrl, Track> m_tracks;
+        static QHash<QByteArray, KUrl> m_fingerprints;
+        static QHash<QByteArray, Track> m_orphanedTracks;
+        static QQueue<QByteArray> m_orphanedOrder;
         static MetaDataManager *m_instance;
+        static int m_resolvedTracks;
+        static int m_failedTracks;
 
     signals:
         void urlChanged(KUrl url);
+        void resolutionProgressChanged();
 };
 
 }
@@ -20,6 +20,7 @@
 
 #include "Player.h"
 #include "MetaDataManager.h"
+#include "Instrumentation.h"
 #include "PlaylistModel.h"
 #include "VideoWidget.h"
 
@@ -32,6 +33,8 @@
 #include <KLocale>
 #include <KMessageBox>
 
+#include <cmath>
+
 #include <Solid/PowerManagement>
 
 namespace MiniPlayer
@@ -39,30 +42,49 @@ namespace MiniPlayer
 
 Player::Player(QObject *parent) : QObject(parent),
     m_mediaObject(new Phonon::MediaObject(this)),
+    m_fadeMediaObject(NULL),
     m_mediaController(new Phonon::MediaController(m_mediaObject)),
     m_audioOutput(new Phonon::AudioOutput(this)),
-    m_videoWidget(new Phonon::VideoWidget()),
+    m_fadeAudioOutput(NULL),
+    m_volumeFader(NULL),
+    m_fadeVolumeFader(NULL),
+    m_audioDataOutput(NULL),
+    m_videoWidget(NULL),
     m_notificationRestrictions(NULL),
     m_appletVideoWidget(NULL),
     m_dialogVideoWidget(NULL),
     m_fullScreenWidget(NULL),
-    m_chaptersGroup(new QActionGroup(this)),
-    m_audioChannelGroup(new QActionGroup(this)),
-    m_subtitlesGroup(new QActionGroup(this)),
-    m_anglesGroup(new QActionGroup(this)),
+    m_brightnessSlider(NULL),
+    m_contrastSlider(NULL),
+    m_hueSlider(NULL),
+    m_saturationSlider(NULL),
+    m_chaptersGroup(NULL),
+    m_audioChannelGroup(NULL),
+    m_subtitlesGroup(NULL),
+    m_anglesGroup(NULL),
     m_aspectRatio(AutomaticRatio),
+    m_transitionOffset(0),
     m_stopSleepCookie(0),
     m_hideFullScreenControlsTimer(0),
     m_playPauseTimer(0),
+    m_queuedTrack(-1),
+    m_crossfadeTrack(-1),
+    m_crossfadeDuration(5000),
+    m_startCrossfadeTimer(0),
+    m_stopCrossfadeTimer(0),
+    m_transitionLatency(-1),
+    m_volume(50),
+    m_brightness(50),
+    m_contrast(50),
+    m_hue(50),
+    m_saturation(50),
+    m_isAnalysisPending(false),
     m_inhibitNotifications(false),
     m_videoMode(false)
 {
-    m_videoWidget->setScaleMode(Phonon::VideoWidget::FitInView);
-    m_videoWidget->setWindowIcon(KIcon("applications-multimedia"));
-    m_videoWidget->setAcceptDrops(true);
+    ScopedTimer timer("Player::Player");
 
-    Phonon::createPath(m_mediaObject, m_audioOutput);
-    Phonon::createPath(m_mediaObject, m_videoWidget);
+    m_audioPath = Phonon::createPath(m_mediaObject, m_audioOutput);
 
     m_actions[OpenMenuAction] = new QAction(i18n("Open"), this);
     m_actions[OpenMenuAction]->setMenu(new KMenu());
@@ -115,47 +137,6 @@ Player::Player(QObject *parent) : QObject(parent),
     m_actions[VideoPropepertiesMenu] = m_actions[VideoMenuAction]->menu()->addAction(i18n("Properties"));
     m_actions[VideoPropepertiesMenu]->setMenu(new KMenu());
 
-    m_brightnessSlider = new QSlider;
-    m_brightnessSlider->setOrientation(Qt::Horizontal);
-    m_brightnessSlider->setRange(0, 100);
-    m_brightnessSlider->setValue(50);
-    m_brightnessSlider->setMinimumWidth(150);
-
-    QWidgetAction *brightnessAction = new QWidgetAction(this);
-    brightnessAction->setDefaultWidget(m_brightnessSlider);
-
-    m_contrastSlider = new QSlider;
-    m_contrastSlider->setOrientation(Qt::Horizontal);
-    m_contrastSlider->setRange(0, 100);
-    m_contrastSlider->setValue(50);
-    m_contrastSlider->setMinimumWidth(150);
-
-    QWidgetAction *contrastAction = new QWidgetAction(this);
-    contrastAction->setDefaultWidget(m_contrastSlider);
-
-    m_hueSlider = new QSlider;
-    m_hueSlider->setOrientation(Qt::Horizontal);
-    m_hueSlider->setRange(0, 100);
-    m_hueSlider->setValue(50);
-    m_hueSlider->setMinimumWidth(150);
-
-    QWidgetAction *hueAction = new QWidgetAction(this);
-    hueAction->setDefaultWidget(m_hueSlider);
-
-    m_saturationSlider = new QSlider;
-    m_saturationSlider->setOrientation(Qt::Horizontal);
-    m_saturationSlider->setRange(0, 100);
-    m_saturationSlider->setValue(50);
-    m_saturationSlider->setMinimumWidth(150);
-
-    QWidgetAction *saturationAction = new QWidgetAction(this);
-    saturationAction->setDefaultWidget(m_saturationSlider);
-
-    m_actions[VideoPropepertiesMenu]->menu()->addAction(brightnessAction);
-    m_actions[VideoPropepertiesMenu]->menu()->addAction(contrastAction);
-    m_actions[VideoPropepertiesMenu]->menu()->addAction(hueAction);
-    m_actions[VideoPropepertiesMenu]->menu()->addAction(saturationAction);
-
     m_actions[AspectRatioMenuAction] = m_actions[VideoMenuAction]->menu()->addAction(i18n("Aspect Ratio"));
     m_actions[AspectRatioMenuAction]->setMenu(new KMenu());
 
@@ -215,14 +196,17 @@ Player::Player(QObject *parent) : QObject(parent),
     randomTrackAction->setCheckable(true);
     randomTrackAction->setData(RandomMode);
 
+    QAction *crossfadeAction = m_actions[PlaybackModeMenuAction]->menu()->addAction(KIcon("view-media-playlist"), i18n("Crossfade"));
+    crossfadeAction->setCheckable(true);
+    crossfadeAction->setData(CrossfadeMode);
+
     QActionGroup *playbackModeActionGroup = new QActionGroup(m_actions[PlaybackModeMenuAction]->menu());
     playbackModeActionGroup->addAction(noRepeatAction);
     playbackModeActionGroup->addAction(currentTrackOnceAction);
     playbackModeActionGroup->addAction(repeatTrackAction);
     playbackModeActionGroup->addAction(repeatPlaylistAction);
     playbackModeActionGroup->addAction(randomTrackAction);
-
-    m_videoWidget->installEventFilter(this);
+    playbackModeActionGroup->addAction(crossfadeAction);
 
     m_keys[TitleKey] = Phonon::TitleMetaData;
     m_keys[ArtistKey] = Phonon::ArtistMetaData;
@@ -234,17 +218,99 @@ Player::Player(QObject *parent) : QObject(parent),
 
     volumeChanged();
     mediaChanged();
-    updateSliders();
 
     connect(m_actions[AspectRatioMenuAction]->menu(), SIGNAL(triggered(QAction*)), this, SLOT(changeAspectRatio(QAction*)));
     connect(m_actions[ChapterMenuAction]->menu(), SIGNAL(triggered(QAction*)), this, SLOT(changeChapter(QAction*)));
     connect(m_actions[AudioMenuAction]->menu(), SIGNAL(triggered(QAction*)), this, SLOT(changeAudioChannel(QAction*)));
     connect(m_actions[SubtitleMenuAction]->menu(), SIGNAL(triggered(QAction*)), this, SLOT(changeSubtitles(QAction*)));
     connect(m_actions[AngleMenuAction]->menu(), SIGNAL(triggered(QAction*)), this, SLOT(changeAngle(QAction*)));
+    connect(m_actions[VideoPropepertiesMenu]->menu(), SIGNAL(aboutToShow()), this, SLOT(updateVideoPropertiesMenu()));
+    connect(m_actions[ChapterMenuAction]->menu(), SIGNAL(aboutToShow()), this, SLOT(updateChaptersMenu()));
+    connect(m_actions[AudioChannelMenuAction]->menu(), SIGNAL(aboutToShow()), this, SLOT(updateAudioChannelsMenu()));
+    connect(m_actions[SubtitleMenuAction]->menu(), SIGNAL(aboutToShow()), this, SLOT(updateSubtitlesMenu()));
+    connect(m_actions[AngleMenuAction]->menu(), SIGNAL(aboutToShow()), this, SLOT(updateAnglesMenu()));
     connect(m_actions[PlayPauseAction], SIGNAL(triggered()), this, SLOT(playPause()));
     connect(m_actions[StopAction], SIGNAL(triggered()), this, SLOT(stop()));
     connect(m_actions[MuteAction], SIGNAL(toggled(bool)), this, SLOT(setAudioMuted(bool)));
+    connectMediaObject();
+    connect(this, SIGNAL(audioAvailableChanged(bool)), this, SLOT(volumeChanged()));
+    connect(this, SIGNAL(currentTrackChanged()), this, SLOT(updateGain()));
+}
+
+void Player::initializeVideo()
+{
+    if (m_videoWidget)
+    {
+        return;
+    }
+
+    ScopedTimer timer("Player::initializeVideo");
+
+    m_videoWidget = new Phonon::VideoWidget();
+    m_videoWidget->setScaleMode(Phonon::VideoWidget::FitInView);
+    m_videoWidget->setWindowIcon(KIcon("applications-multimedia"));
+    m_videoWidget->setAcceptDrops(true);
+    m_videoWidget->setBrightness((m_brightness > 0)?(((qreal) m_brightness / 50) - 1):-1);
+    m_videoWidget->setContrast((m_contrast > 0)?(((qreal) m_contrast / 50) - 1):-1);
+    m_videoWidget->setHue((m_hue > 0)?(((qreal) m_hue / 50) - 1):-1);
+    m_videoWidget->setSaturation((m_saturation > 0)?(((qreal) m_saturation / 50) - 1):-1);
+    m_videoWidget->installEventFilter(this);
+
+    m_videoPath = Phonon::createPath(m_mediaObject, m_videoWidget);
+
+    updateAspectRatio();
+
+    if (m_appletVideoWidget)
+    {
+        setVideoMode(m_videoMode);
+    }
+
+    connect(this, SIGNAL(destroyed()), m_videoWidget, SLOT(deleteLater()));
+}
+
+void Player::timerEvent(QTimerEvent *event)
+{
+    Instrumentation::recordWakeup("Player");
+
+    if (event->timerId() == m_hideFullScreenControlsTimer && m_fullScreenWidget && !m_fullScreenUi.controlsWidget->underMouse())
+    {
+        m_fullScreenUi.videoWidget->setCursor(QCursor(Qt::BlankCursor));
+        m_fullScreenUi.titleLabel->hide();
+        m_fullScreenUi.controlsWidget->hide();
+
+        m_hideFullScreenControlsTimer = 0;
+    }
+    else if (event->timerId() == m_playPauseTimer)
+    {
+        m_actions[PlayPauseAction]->trigger();
+
+        m_playPauseTimer = 0;
+    }
+    else if (event->timerId() == m_startCrossfadeTimer)
+    {
+        m_startCrossfadeTimer = 0;
+
+        startCrossfade();
+    }
+    else if (event->timerId() == m_stopCrossfadeTimer)
+    {
+        m_stopCrossfadeTimer = 0;
+
+        if (m_fadeMediaObject)
+        {
+            m_fadeMediaObject->stop();
+            m_fadeMediaObject->setCurrentSource(Phonon::MediaSource());
+        }
+    }
+
+    killTimer(event->timerId());
+}
+
+void Player::connectMediaObject()
+{
     connect(m_mediaObject, SIGNAL(finished()), this, SLOT(trackFinished()));
+    connect(m_mediaObject, SIGNAL(aboutToFinish()), this, SLOT(enqueueNextTrack()));
+    connect(m_mediaObject, SIGNAL(currentSourceChanged(Phonon::MediaSource)), this, SLOT(sourceChanged(Phonon::MediaSource)));
     connect(m_mediaObject, SIGNAL(stateChanged(Phonon::State,Phonon::State)), this, SLOT(stateChanged(Phonon::State)));
     connect(m_mediaObject, SIGNAL(metaDataChanged()), this, SIGNAL(metaDataChanged()));
     connect(m_mediaObject, SIGNAL(metaDataChanged()), this, SLOT(updateMetaData()));
@@ -254,7 +320,7 @@ Player::Player(QObject *parent) : QObject(parent),
     connect(m_mediaObject, SIGNAL(hasVideoChanged(bool)), m_actions[VideoMenuAction], SLOT(setEnabled(bool)));
     connect(m_mediaObject, SIGNAL(hasVideoChanged(bool)), m_actions[FullScreenAction], SLOT(setEnabled(bool)));
     connect(m_mediaObject, SIGNAL(seekableChanged(bool)), this, SIGNAL(seekableChanged(bool)));
-    connect(m_audioOutput, SIGNAL(volumeChanged(qreal)), this, SLOT(volumeChanged(qreal)));
+    connect(m_mediaObject, SIGNAL(tick(qint64)), this, SIGNAL(tick(qint64)));
     connect(m_audioOutput, SIGNAL(volumeChanged(qreal)), this, SLOT(volumeChanged()));
     connect(m_audioOutput, SIGNAL(mutedChanged(bool)), this, SIGNAL(audioMutedChanged(bool)));
     connect(m_audioOutput, SIGNAL(mutedChanged(bool)), this, SLOT(volumeChanged()));
@@ -263,43 +329,133 @@ Player::Player(QObject *parent) : QObject(parent),
     connect(m_mediaController, SIGNAL(availableSubtitlesChanged()), this, SLOT(availableSubtitlesChanged()));
     connect(m_mediaController, SIGNAL(availableAnglesChanged(int)), this, SLOT(availableAnglesChanged()));
     connect(m_mediaController, SIGNAL(availableTitlesChanged(int)), this, SLOT(availableTitlesChanged()));
-    connect(m_brightnessSlider, SIGNAL(valueChanged(int)), this, SLOT(setBrightness(int)));
-    connect(m_contrastSlider, SIGNAL(valueChanged(int)), this, SLOT(setContrast(int)));
-    connect(m_hueSlider, SIGNAL(valueChanged(int)), this, SLOT(setHue(int)));
-    connect(m_saturationSlider, SIGNAL(valueChanged(int)), this, SLOT(setSaturation(int)));
-    connect(this, SIGNAL(audioAvailableChanged(bool)), this, SLOT(volumeChanged()));
-    connect(this, SIGNAL(destroyed()), m_videoWidget, SLOT(deleteLater()));
+    connect(m_mediaObject, SIGNAL(prefinishMarkReached(qint32)), this, SLOT(prepareCrossfade(qint32)));
 }
 
-void Player::timerEvent(QTimerEvent *event)
+void Player::startCrossfade()
 {
-    if (event->timerId() == m_hideFullScreenControlsTimer && m_fullScreenWidget && !m_fullScreenUi.controlsWidget->underMouse())
+    if (!m_fadeMediaObject || m_crossfadeTrack < 0 || !m_playlist)
     {
-        m_fullScreenUi.videoWidget->setCursor(QCursor(Qt::BlankCursor));
-        m_fullScreenUi.titleLabel->hide();
-        m_fullScreenUi.controlsWidget->hide();
+        return;
+    }
 
-        m_hideFullScreenControlsTimer = 0;
+    const int track = m_crossfadeTrack;
+
+    m_crossfadeTrack = -1;
+
+    disconnect(m_mediaObject, 0, this, 0);
+    disconnect(m_mediaObject, 0, m_actions[VideoMenuAction], 0);
+    disconnect(m_mediaObject, 0, m_actions[FullScreenAction], 0);
+    disconnect(m_audioOutput, 0, this, 0);
+    m_mediaController->deleteLater();
+
+    qSwap(m_mediaObject, m_fadeMediaObject);
+    qSwap(m_audioOutput, m_fadeAudioOutput);
+    qSwap(m_volumeFader, m_fadeVolumeFader);
+    qSwap(m_audioPath, m_fadeAudioPath);
+
+    if (m_videoWidget)
+    {
+        m_videoPath.reconnect(m_mediaObject, m_videoWidget);
     }
-    else if (event->timerId() == m_playPauseTimer)
+
+    if (m_audioDataOutput)
     {
-        m_actions[PlayPauseAction]->trigger();
+        m_audioDataPath.reconnect(m_mediaObject, m_audioDataOutput);
+    }
 
-        m_playPauseTimer = 0;
+    m_mediaController = new Phonon::MediaController(m_mediaObject);
+
+    connectMediaObject();
+    updateTickInterval();
+
+    m_fadeMediaObject->setTickInterval(0);
+
+    m_fadeMediaObject->clearQueue();
+    m_fadeVolumeFader->fadeOut(m_crossfadeDuration);
+
+    m_mediaObject->play();
+
+    m_volumeFader->fadeIn(m_crossfadeDuration);
+
+    m_stopCrossfadeTimer = startTimer(m_crossfadeDuration);
+
+    m_playlist->setCurrentTrack(track);
+    m_playlist->setLastPlayedDate(QDateTime::currentDateTime());
+
+    updateCrossfade();
+    mediaChanged();
+    videoChanged();
+    availableChaptersChanged();
+    availableAudioChannelsChanged();
+    availableSubtitlesChanged();
+    availableAnglesChanged();
+
+    if (m_mediaObject->currentSource().type() == Phonon::MediaSource::Disc)
+    {
+        availableTitlesChanged();
     }
 
-    killTimer(event->timerId());
+    emit durationChanged(duration());
+    emit seekableChanged(isSeekable());
+    emit metaDataChanged();
+}
+
+void Player::stopCrossfade()
+{
+    killTimer(m_startCrossfadeTimer);
+    killTimer(m_stopCrossfadeTimer);
+
+    m_startCrossfadeTimer = 0;
+    m_stopCrossfadeTimer = 0;
+    m_crossfadeTrack = -1;
+
+    if (m_fadeMediaObject)
+    {
+        m_fadeMediaObject->stop();
+        m_fadeMediaObject->setCurrentSource(Phonon::MediaSource());
+    }
+
+    if (m_volumeFader)
+    {
+        m_volumeFader->setVolume(1);
+    }
+}
+
+void Player::updateTickInterval()
+{
+    int interval = 0;
+    QMap<QObject*, int>::const_iterator iterator;
+
+    for (iterator = m_tickIntervals.constBegin(); iterator != m_tickIntervals.constEnd(); ++iterator)
+    {
+        if (interval == 0 || iterator.value() < interval)
+        {
+            interval = iterator.value();
+        }
+    }
+
+    m_mediaObject->setTickInterval(interval);
+}
+
+void Player::removeTickClient(QObject *client)
+{
+    m_tickIntervals.remove(client);
+
+    updateTickInterval();
 }
 
-void Player::volumeChanged(qreal volume)
+void Player::volumeChanged()
 {
     KIcon icon;
 
-    if (volume >= 0)
+    if (sender() == m_audioOutput)
     {
-        emit volumeChanged((int) (volume * 100));
+        m_volume = qBound(0, volume(), 100);
     }
 
+    emit volumeChanged(volume());
+
     if (isAudioMuted())
     {
         m_actions[VolumeToggleAction]->setText(i18n("Muted"));
@@ -365,235 +521,571 @@ void Player::mediaChanged()
 void Player::availableChaptersChanged()
 {
     m_actions[ChapterMenuAction]->menu()->clear();
-    m_actions[ChapterMenuAction]->setEnabled(false);
+    m_actions[ChapterMenuAction]->setEnabled(m_mediaController->availableChapters() > 1);
+
+    if (m_chaptersGroup)
+    {
+        m_chaptersGroup->deleteLater();
+        m_chaptersGroup = NULL;
+    }
+}
+
+void Player::updateChaptersMenu()
+{
+    if (!m_actions[ChapterMenuAction]->menu()->isEmpty())
+    {
+        return;
+    }
 
-    m_chaptersGroup->deleteLater();
     m_chaptersGroup = new QActionGroup(this);
     m_chaptersGroup->setExclusive(true);
 
-    if (m_mediaController->availableChapters() > 1)
+    for (int i = 0; i < m_mediaController->availableChapters(); ++i)
     {
-        for (int i = 0; i < m_mediaController->availableChapters(); ++i)
-        {
-            QAction *action = m_actions[ChapterMenuAction]->menu()->addAction(i18n("Chapter %1", i));
-            action->setData(i);
-            action->setCheckable(true);
-
-            m_chaptersGroup->addAction(action);
-        }
+        QAction *action = m_actions[ChapterMenuAction]->menu()->addAction(i18n("Chapter %1", i));
+        action->setData(i);
+        action->setCheckable(true);
 
-        m_actions[ChapterMenuAction]->setEnabled(true);
+        m_chaptersGroup->addAction(action);
     }
 }
 
 void Player::availableAudioChannelsChanged()
 {
     m_actions[AudioChannelMenuAction]->menu()->clear();
-    m_actions[AudioChannelMenuAction]->setEnabled(false);
+    m_actions[AudioChannelMenuAction]->setEnabled(m_mediaController->availableAudioChannels().count() > 1);
+
+    if (m_audioChannelGroup)
+    {
+        m_audioChannelGroup->deleteLater();
+        m_audioChannelGroup = NULL;
+    }
+}
+
+void Player::updateAudioChannelsMenu()
+{
+    if (!m_actions[AudioChannelMenuAction]->menu()->isEmpty())
+    {
+        return;
+    }
 
-    m_audioChannelGroup->deleteLater();
     m_audioChannelGroup = new QActionGroup(this);
     m_audioChannelGroup->setExclusive(true);
 
-    if (m_mediaController->availableAudioChannels().count() > 1)
+    for (int i = 0; i < m_mediaController->availableAudioChannels().count(); ++i)
     {
-        for (int i = 0; i < m_mediaController->availableAudioChannels().count(); ++i)
-        {
-            QAction *action = m_actions[AudioChannelMenuAction]->menu()->addAction(m_mediaController->availableAudioChannels().at(i).name());
-            action->setData(i);
-            action->setCheckable(true);
-
-            m_audioChannelGroup->addAction(action);
-        }
+        QAction *action = m_actions[AudioChannelMenuAction]->menu()->addAction(m_mediaController->availableAudioChannels().at(i).name());
+        action->setData(i);
+        action->setCheckable(true);
 
-        m_actions[AudioChannelMenuAction]->setEnabled(true);
+        m_audioChannelGroup->addAction(action);
     }
 }
 
 void Player::availableSubtitlesChanged()
 {
     m_actions[SubtitleMenuAction]->menu()->clear();
-    m_actions[SubtitleMenuAction]->setEnabled(false);
+    m_actions[SubtitleMenuAction]->setEnabled(m_mediaController->availableSubtitles().count() > 0);
+
+    if (m_subtitlesGroup)
+    {
+        m_subtitlesGroup->deleteLater();
+        m_subtitlesGroup = NULL;
+    }
+}
+
+void Player::updateSubtitlesMenu()
+{
+    if (!m_actions[SubtitleMenuAction]->menu()->isEmpty())
+    {
+        return;
+    }
 
-    m_subtitlesGroup->deleteLater();
     m_subtitlesGroup = new QActionGroup(this);
     m_subtitlesGroup->setExclusive(true);
 
-    if (m_mediaController->availableSubtitles().count())
+    for (int i = 0; i < m_mediaController->availableSubtitles().count(); ++i)
     {
-        for (int i = 0; i < m_mediaController->availableSubtitles().count(); ++i)
-        {
-            QAction *action = m_actions[SubtitleMenuAction]->menu()->addAction(m_mediaController->availableSubtitles().at(i).name());
-            action->setData(i);
-            action->setCheckable(true);
-
-            m_subtitlesGroup->addAction(action);
-        }
+        QAction *action = m_actions[SubtitleMenuAction]->menu()->addAction(m_mediaController->availableSubtitles().at(i).name());
+        action->setData(i);
+        action->setCheckable(true);
 
-        m_actions[SubtitleMenuAction]->setEnabled(true);
+        m_subtitlesGroup->addAction(action);
     }
 }
 
 void Player::availableAnglesChanged()
 {
     m_actions[AngleMenuAction]->menu()->clear();
-    m_actions[AngleMenuAction]->setEnabled(false);
+    m_actions[AngleMenuAction]->setEnabled(m_mediaController->availableAngles() > 1);
+
+    if (m_anglesGroup)
+    {
+        m_anglesGroup->deleteLater();
+        m_anglesGroup = NULL;
+    }
+}
+
+void Player::updateAnglesMenu()
+{
+    if (!m_actions[AngleMenuAction]->menu()->isEmpty())
+    {
+        return;
+    }
 
-    m_anglesGroup->deleteLater();
     m_anglesGroup = new QActionGroup(this);
     m_anglesGroup->setExclusive(true);
 
-    if (m_mediaController->availableAngles() > 1)
+    for (int i = 0; i < m_mediaController->availableAngles(); ++i)
+    {
+        QAction *action = m_actions[AngleMenuAction]->menu()->addAction(i18n("Angle %1", i));
+        action->setData(i);
+        action->setCheckable(true);
+
+        m_anglesGroup->addAction(action);
+    }
+}
+
+void Player::availableTitlesChanged()
+{
+    const QString udi = m_mediaObject->currentSource().deviceName();
+    KUrl::List tracks;
+
+    for (int i = 1; i <= m_mediaController->availableTitles(); ++i)
     {
-        for (int i = 0; i < m_mediaController->availableAngles(); ++i)
+        KUrl url = KUrl(QString("disc:/%1/%2").arg(udi).arg(i));
+
+        tracks.append(url);
+
+        MetaDataManager::setMetaData(url, TitleKey, i18n("Track %1", i));
+    }
+
+    emit requestDevicePlaylist(udi, tracks);
+}
+
+void Player::currentTrackChanged(int track, PlayerReaction reaction)
+{
+    if (!m_playlist || m_playlist->trackCount() == 0)
+    {
+        if (m_mediaObject->currentSource().type() != Phonon::MediaSource::Disc)
         {
-            QAction *action = m_actions[AngleMenuAction]->menu()->addAction(i18n("Angle %1", i));
-            action->setData(i);
-            action->setCheckable(true);
+            stop();
+        }
+
+        return;
+    }
+
+    if (reaction == PlayReaction || reaction == PauseReaction)
+    {
+        stopCrossfade();
+
+        m_queuedTrack = -1;
+        m_transitionOffset = 0;
+        m_transitionTime.start();
+
+        initializeVideo();
+
+        m_mediaObject->clearQueue();
+        m_mediaObject->setCurrentSource(Phonon::MediaSource(m_playlist->track(track)));
+
+        m_playlist->setLastPlayedDate(QDateTime::currentDateTime());
+    }
 
-            m_anglesGroup->addAction(action);
+    switch (reaction)
+    {
+        case PlayReaction:
+            play();
+
+            break;
+        case PauseReaction:
+            pause();
+
+            break;
+        case StopReaction:
+            stop();
+
+            break;
+        default:
+            break;
+    }
+
+    emit currentTrackChanged();
+}
+
+void Player::stateChanged(Phonon::State state)
+{
+    const PlayerState translatedState = translateState(state);
+
+    if (translatedState == PlayingState)
+    {
+        updateTransitionLatency();
+    }
+
+    mediaChanged();
+    videoChanged();
+
+    if (isVideoAvailable() && translatedState == PlayingState && !m_inhibitNotifications)
+    {
+        m_stopSleepCookie = Solid::PowerManagement::beginSuppressingSleep("Plasma MiniPlayerApplet: playing video");
+
+        if (!m_notificationRestrictions)
+        {
+            m_notificationRestrictions = new KNotificationRestrictions(KNotificationRestrictions::NonCriticalServices, this);
         }
+    }
+    else if (m_notificationRestrictions)
+    {
+        Solid::PowerManagement::stopSuppressingSleep(m_stopSleepCookie);
 
-        m_actions[AngleMenuAction]->setEnabled(true);
+        m_notificationRestrictions->deleteLater();
+        m_notificationRestrictions = NULL;
+    }
+
+    if (state == Phonon::ErrorState && m_mediaObject->errorType() != Phonon::NoError)
+    {
+        KMessageBox::error(NULL, m_mediaObject->currentSource().url().toString().replace("%20", " ") + "\n\n" + m_mediaObject->errorString());
+
+        emit errorOccured(m_mediaObject->errorString());
+    }
+
+    if (translatedState == StoppedState && isFullScreen())
+    {
+        m_fullScreenUi.titleLabel->clear();
     }
+
+    emit stateChanged(translatedState);
+    emit audioAvailableChanged(translatedState != StoppedState);
 }
 
-void Player::availableTitlesChanged()
+void Player::changeAspectRatio(QAction *action)
+{
+    setAspectRatio(static_cast<AspectRatio>(action->data().toInt()));
+}
+
+void Player::changeChapter(QAction *action)
+{
+    m_mediaController->setCurrentChapter(action->data().toInt());
+}
+
+void Player::changeAudioChannel(QAction *action)
+{
+    m_mediaController->setCurrentAudioChannel(m_mediaController->availableAudioChannels().at(action->data().toInt()));
+}
+
+void Player::changeSubtitles(QAction *action)
+{
+    m_mediaController->setCurrentSubtitle(m_mediaController->availableSubtitles().at(action->data().toInt()));
+}
+
+void Player::changeAngle(QAction *action)
+{
+    m_mediaController->setCurrentAngle(action->data().toInt());
+}
+
+void Player::trackFinished()
+{
+    videoChanged();
+
+    if (m_playlist)
+    {
+        m_playlist->setCurrentTrack(m_playlist->nextTrack(), PlayReaction);
+    }
+
+    if (m_videoWidget)
+    {
+        m_videoWidget->update();
+    }
+}
+
+void Player::enqueueNextTrack()
+{
+    m_queuedTrack = -1;
+
+    m_mediaObject->clearQueue();
+
+    if (!m_playlist || m_crossfadeTrack >= 0 || m_mediaObject->currentSource().type() == Phonon::MediaSource::Disc)
+    {
+        return;
+    }
+
+    const int track = m_playlist->nextTrack();
+
+    if (track < 0)
+    {
+        return;
+    }
+
+    m_queuedTrack = track;
+    m_transitionOffset = m_mediaObject->remainingTime();
+    m_transitionTime.start();
+
+    m_mediaObject->enqueue(Phonon::MediaSource(m_playlist->track(track)));
+}
+
+void Player::updateQueue()
+{
+    if (m_queuedTrack >= 0)
+    {
+        enqueueNextTrack();
+    }
+}
+
+void Player::sourceChanged(const Phonon::MediaSource &source)
+{
+    if (m_queuedTrack < 0)
+    {
+        return;
+    }
+
+    const int track = m_queuedTrack;
+
+    m_queuedTrack = -1;
+
+    updateTransitionLatency();
+
+    if (m_playlist && m_playlist->track(track) == KUrl(source.url()))
+    {
+        m_playlist->setCurrentTrack(track);
+        m_playlist->setLastPlayedDate(QDateTime::currentDateTime());
+    }
+}
+
+void Player::updateCrossfade()
+{
+    m_mediaObject->setPrefinishMark((m_playlist && m_playlist->playbackMode() == CrossfadeMode)?(m_crossfadeDuration + 2000):0);
+}
+
+void Player::prepareCrossfade(qint32 remaining)
+{
+    if (!m_playlist || m_playlist->playbackMode() != CrossfadeMode || m_mediaObject->currentSource().type() == Phonon::MediaSource::Disc)
+    {
+        return;
+    }
+
+    const int track = m_playlist->nextTrack();
+
+    if (track < 0)
+    {
+        return;
+    }
+
+    if (!m_fadeMediaObject)
+    {
+        m_fadeMediaObject = new Phonon::MediaObject(this);
+        m_fadeAudioOutput = new Phonon::AudioOutput(this);
+        m_fadeVolumeFader = new Phonon::VolumeFaderEffect(this);
+        m_fadeVolumeFader->setFadeCurve(Phonon::VolumeFaderEffect::Fade3Decibel);
+        m_fadeAudioPath = Phonon::createPath(m_fadeMediaObject, m_fadeAudioOutput);
+        m_fadeAudioPath.insertEffect(m_fadeVolumeFader);
+    }
+
+    if (!m_volumeFader)
+    {
+        m_volumeFader = new Phonon::VolumeFaderEffect(this);
+        m_volumeFader->setFadeCurve(Phonon::VolumeFaderEffect::Fade3Decibel);
+
+        m_audioPath.insertEffect(m_volumeFader);
+    }
+
+    killTimer(m_stopCrossfadeTimer);
+
+    m_stopCrossfadeTimer = 0;
+    m_queuedTrack = -1;
+    m_crossfadeTrack = track;
+
+    m_mediaObject->clearQueue();
+
+    m_fadeAudioOutput->setVolume(((qreal) m_volume / 100) * gainFactor(m_playlist->track(track)));
+    m_fadeAudioOutput->setMuted(m_audioOutput->isMuted());
+
+    m_fadeVolumeFader->setVolume(0);
+
+    m_fadeMediaObject->setCurrentSource(Phonon::MediaSource(m_playlist->track(track)));
+    m_fadeMediaObject->pause();
+
+    scheduleCrossfade(remaining);
+}
+
+void Player::scheduleCrossfade(qint64 remaining)
+{
+    killTimer(m_startCrossfadeTimer);
+
+    m_startCrossfadeTimer = 0;
+
+    if (m_crossfadeTrack < 0)
+    {
+        return;
+    }
+
+    if (remaining > (m_crossfadeDuration + 2000))
+    {
+        stopCrossfade();
+
+        return;
+    }
+
+    if (m_mediaObject->state() == Phonon::PlayingState || m_mediaObject->state() == Phonon::BufferingState)
+    {
+        m_startCrossfadeTimer = startTimer(qMax(qint64(0), (remaining - m_crossfadeDuration)));
+    }
+}
+
+void Player::updateGain()
 {
-    const QString udi = m_mediaObject->currentSource().deviceName();
-    KUrl::List tracks;
+    finishAnalysis();
 
-    for (int i = 1; i <= m_mediaController->availableTitles(); ++i)
+    const KUrl url = this->url();
+
+    setVolume(m_volume);
+
+    if (!url.isValid() || m_mediaObject->currentSource().type() == Phonon::MediaSource::Disc || MetaDataManager::hasGain(url))
     {
-        KUrl url = KUrl(QString("disc:/%1/%2").arg(udi).arg(i));
+        return;
+    }
 
-        tracks.append(url);
+    if (!m_audioDataOutput)
+    {
+        m_audioDataOutput = new Phonon::AudioDataOutput(this);
+        m_audioDataOutput->setDataSize(4096);
+        m_audioDataPath = Phonon::createPath(m_mediaObject, m_audioDataOutput);
 
-        MetaDataManager::setMetaData(url, TitleKey, i18n("Track %1", i));
+        connect(m_audioDataOutput, SIGNAL(dataReady(QMap<Phonon::AudioDataOutput::Channel,QVector<qint16> >)), this, SLOT(analyzeData(QMap<Phonon::AudioDataOutput::Channel,QVector<qint16> >)));
     }
 
-    emit requestDevicePlaylist(udi, tracks);
+    m_analyzedUrl = url;
+    m_isAnalysisPending = true;
 }
 
-void Player::currentTrackChanged(int track, PlayerReaction reaction)
+void Player::updateGain(const KUrl &url)
 {
-    if (!m_playlist || m_playlist->trackCount() == 0)
+    if (url == this->url())
     {
-        if (m_mediaObject->currentSource().type() != Phonon::MediaSource::Disc)
-        {
-            stop();
-        }
+        setVolume(m_volume);
+    }
+}
 
+void Player::analyzeData(const QMap<Phonon::AudioDataOutput::Channel, QVector<qint16> > &data)
+{
+    if (!m_analyzedUrl.isValid() || m_analyzedUrl != url())
+    {
         return;
     }
 
-    if (reaction == PlayReaction || reaction == PauseReaction)
+    if (m_isAnalysisPending)
     {
-        m_mediaObject->setCurrentSource(Phonon::MediaSource(m_playlist->track(track)));
+        m_loudnessAnalyzer.reset(m_audioDataOutput->sampleRate());
 
-        m_playlist->setLastPlayedDate(QDateTime::currentDateTime());
+        m_isAnalysisPending = false;
     }
 
-    switch (reaction)
-    {
-        case PlayReaction:
-            play();
-
-            break;
-        case PauseReaction:
-            pause();
+    m_loudnessAnalyzer.process(data);
 
-            break;
-        case StopReaction:
-            stop();
+    const qint64 duration = MetaDataManager::duration(m_analyzedUrl);
 
-            break;
-        default:
-            break;
+    if (duration > 0 && m_loudnessAnalyzer.analyzedTime() >= duration)
+    {
+        finishAnalysis();
     }
-
-    emit currentTrackChanged();
 }
 
-void Player::stateChanged(Phonon::State state)
+void Player::finishAnalysis()
 {
-    const PlayerState translatedState = translateState(state);
-
-    mediaChanged();
-    videoChanged();
-
-    if (isVideoAvailable() && translatedState == PlayingState && !m_inhibitNotifications)
+    if (m_audioDataOutput)
     {
-        m_stopSleepCookie = Solid::PowerManagement::beginSuppressingSleep("Plasma MiniPlayerApplet: playing video");
-
-        if (!m_notificationRestrictions)
-        {
-            m_notificationRestrictions = new KNotificationRestrictions(KNotificationRestrictions::NonCriticalServices, this);
-        }
+        m_audioDataPath.disconnect();
+        m_audioDataOutput->deleteLater();
+        m_audioDataOutput = NULL;
     }
-    else if (m_notificationRestrictions)
-    {
-        Solid::PowerManagement::stopSuppressingSleep(m_stopSleepCookie);
 
-        m_notificationRestrictions->deleteLater();
-        m_notificationRestrictions = NULL;
+    if (!m_analyzedUrl.isValid())
+    {
+        return;
     }
 
-    if (state == Phonon::ErrorState && m_mediaObject->errorType() != Phonon::NoError)
+    const KUrl url = m_analyzedUrl;
+    const qint64 duration = MetaDataManager::duration(url);
+
+    m_analyzedUrl = KUrl();
+
+    if (m_loudnessAnalyzer.isValid() && !MetaDataManager::hasGain(url) && duration > 0 && m_loudnessAnalyzer.analyzedTime() >= (duration * 0.9))
     {
-        KMessageBox::error(NULL, m_mediaObject->currentSource().url().toString().replace("%20", " ") + "\n\n" + m_mediaObject->errorString());
+        MetaDataManager::setGain(url, m_loudnessAnalyzer.gain(), m_loudnessAnalyzer.peak());
 
-        emit errorOccured(m_mediaObject->errorString());
+        emit modified();
     }
+}
 
-    if (translatedState == StoppedState && isFullScreen())
+void Player::updateTransitionLatency()
+{
+    if (!m_transitionTime.isValid())
     {
-        m_fullScreenUi.titleLabel->clear();
+        return;
     }
 
-    emit stateChanged(translatedState);
-    emit audioAvailableChanged(translatedState != StoppedState);
-}
+    m_transitionLatency = qMax((qint64) 0, (m_transitionTime.elapsed() - m_transitionOffset));
+    m_transitionTime = QTime();
 
-void Player::changeAspectRatio(QAction *action)
-{
-    setAspectRatio(static_cast<AspectRatio>(action->data().toInt()));
+    Instrumentation::record("Player::transitionLatency", (m_transitionLatency * 1000));
 }
 
-void Player::changeChapter(QAction *action)
+void Player::updateVideoPropertiesMenu()
 {
-    m_mediaController->setCurrentChapter(action->data().toInt());
-}
+    if (m_brightnessSlider)
+    {
+        return;
+    }
 
-void Player::changeAudioChannel(QAction *action)
-{
-    m_mediaController->setCurrentAudioChannel(m_mediaController->availableAudioChannels().at(action->data().toInt()));
-}
+    m_brightnessSlider = new QSlider;
+    m_brightnessSlider->setOrientation(Qt::Horizontal);
+    m_brightnessSlider->setRange(0, 100);
+    m_brightnessSlider->setValue(m_brightness);
+    m_brightnessSlider->setMinimumWidth(150);
 
-void Player::changeSubtitles(QAction *action)
-{
-    m_mediaController->setCurrentSubtitle(m_mediaController->availableSubtitles().at(action->data().toInt()));
-}
+    QWidgetAction *brightnessAction = new QWidgetAction(this);
+    brightnessAction->setDefaultWidget(m_brightnessSlider);
 
-void Player::changeAngle(QAction *action)
-{
-    m_mediaController->setCurrentAngle(action->data().toInt());
-}
+    m_contrastSlider = new QSlider;
+    m_contrastSlider->setOrientation(Qt::Horizontal);
+    m_contrastSlider->setRange(0, 100);
+    m_contrastSlider->setValue(m_contrast);
+    m_contrastSlider->setMinimumWidth(150);
 
-void Player::trackFinished()
-{
-    videoChanged();
+    QWidgetAction *contrastAction = new QWidgetAction(this);
+    contrastAction->setDefaultWidget(m_contrastSlider);
 
-    if (m_playlist)
-    {
-        m_playlist->setCurrentTrack(m_playlist->nextTrack(), PlayReaction);
-    }
+    m_hueSlider = new QSlider;
+    m_hueSlider->setOrientation(Qt::Horizontal);
+    m_hueSlider->setRange(0, 100);
+    m_hueSlider->setValue(m_hue);
+    m_hueSlider->setMinimumWidth(150);
+
+    QWidgetAction *hueAction = new QWidgetAction(this);
+    hueAction->setDefaultWidget(m_hueSlider);
+
+    m_saturationSlider = new QSlider;
+    m_saturationSlider->setOrientation(Qt::Horizontal);
+    m_saturationSlider->setRange(0, 100);
+    m_saturationSlider->setValue(m_saturation);
+    m_saturationSlider->setMinimumWidth(150);
+
+    QWidgetAction *saturationAction = new QWidgetAction(this);
+    saturationAction->setDefaultWidget(m_saturationSlider);
+
+    m_actions[VideoPropepertiesMenu]->menu()->addAction(brightnessAction);
+    m_actions[VideoPropepertiesMenu]->menu()->addAction(contrastAction);
+    m_actions[VideoPropepertiesMenu]->menu()->addAction(hueAction);
+    m_actions[VideoPropepertiesMenu]->menu()->addAction(saturationAction);
 
-    m_videoWidget->update();
+    updateSliders();
 }
 
 void Player::updateSliders()
 {
+    if (!m_brightnessSlider)
+    {
+        return;
+    }
+
     disconnect(m_brightnessSlider, SIGNAL(valueChanged(int)), this, SLOT(setBrightness(int)));
     disconnect(m_contrastSlider, SIGNAL(valueChanged(int)), this, SLOT(setContrast(int)));
     disconnect(m_hueSlider, SIGNAL(valueChanged(int)), this, SLOT(setHue(int)));
@@ -639,6 +1131,7 @@ void Player::updateMetaData()
         track.keys[DateKey] = metaData(DateKey, false);
         track.duration = duration();
 
+        MetaDataManager::readGain(m_mediaObject, track);
         MetaDataManager::setMetaData(url(), track);
     }
 }
@@ -653,6 +1146,11 @@ void Player::registerDialogVideoWidget(VideoWidget *videoWidget)
 {
     m_dialogVideoWidget = videoWidget;
     m_dialogVideoWidget->installEventFilter(this);
+
+    if (m_videoWidget && m_appletVideoWidget)
+    {
+        setVideoMode(m_videoMode);
+    }
 }
 
 void Player::seekBackward()
@@ -699,6 +1197,8 @@ void Player::openDisc(const QString &device, PlaylistSource type)
             break;
     }
 
+    initializeVideo();
+
     m_mediaObject->setCurrentSource(Phonon::MediaSource(discType, device));
     m_mediaObject->play();
 
@@ -712,6 +1212,8 @@ void Player::openDisc(const QString &device, PlaylistSource type)
 
 void Player::play()
 {
+    initializeVideo();
+
     if ((m_mediaObject->currentSource().type() == Phonon::MediaSource::Invalid || !m_mediaObject->currentSource().url().isValid()) && m_playlist)
     {
         currentTrackChanged(m_playlist->currentTrack(), PlayReaction);
@@ -720,6 +1222,11 @@ void Player::play()
     {
         m_mediaObject->play();
 
+        if (m_crossfadeTrack >= 0 && !m_startCrossfadeTimer)
+        {
+            m_startCrossfadeTimer = startTimer(qMax(qint64(0), (m_mediaObject->remainingTime() - m_crossfadeDuration)));
+        }
+
         emit volumeChanged(volume());
     }
 }
@@ -746,11 +1253,43 @@ void Player::playPause()
 
 void Player::pause()
 {
+    killTimer(m_startCrossfadeTimer);
+
+    m_startCrossfadeTimer = 0;
+
+    if (m_stopCrossfadeTimer)
+    {
+        killTimer(m_stopCrossfadeTimer);
+
+        m_stopCrossfadeTimer = 0;
+
+        if (m_fadeMediaObject)
+        {
+            m_fadeMediaObject->stop();
+            m_fadeMediaObject->setCurrentSource(Phonon::MediaSource());
+        }
+
+        if (m_volumeFader)
+        {
+            m_volumeFader->setVolume(1);
+        }
+    }
+    else if (m_fadeMediaObject && m_crossfadeTrack >= 0)
+    {
+        m_fadeMediaObject->pause();
+    }
+
     m_mediaObject->pause();
 }
 
 void Player::stop()
 {
+    stopCrossfade();
+
+    m_queuedTrack = -1;
+    m_transitionTime = QTime();
+
+    m_mediaObject->clearQueue();
     m_mediaObject->stop();
     m_mediaObject->setCurrentSource(Phonon::MediaSource());
 }
@@ -782,9 +1321,14 @@ void Player::setPlaylist(PlaylistModel *playlist)
     {
         disconnect(m_playlist, SIGNAL(playbackModeChanged(PlaybackMode)), this, SIGNAL(playbackModeChanged(PlaybackMode)));
         disconnect(m_playlist, SIGNAL(trackAdded(int)), this, SIGNAL(trackAdded(int)));
-        disconnect(m_playlist, SIGNAL(trackRemoved(int)), this, SIGNAL(trackRemoved(int)));
+        disconnect(m_playlist, SIGNAL(trackRemoved(int,int)), this, SIGNAL(trackRemoved(int,int)));
         disconnect(m_playlist, SIGNAL(trackChanged(int)), this, SIGNAL(trackChanged(int)));
         disconnect(m_playlist, SIGNAL(tracksChanged()), this, SIGNAL(playlistChanged()));
+        disconnect(m_playlist, SIGNAL(tracksChanged()), this, SLOT(updateQueue()));
+        disconnect(m_playlist, SIGNAL(trackAdded(int)), this, SLOT(updateQueue()));
+        disconnect(m_playlist, SIGNAL(trackRemoved(int,int)), this, SLOT(updateQueue()));
+        disconnect(m_playlist, SIGNAL(playbackModeChanged(PlaybackMode)), this, SLOT(updateQueue()));
+        disconnect(m_playlist, SIGNAL(playbackModeChanged(PlaybackMode)), this, SLOT(updateCrossfade()));
         disconnect(m_playlist, SIGNAL(modified()), this, SLOT(mediaChanged()));
         disconnect(m_playlist, SIGNAL(currentTrackChanged(int,PlayerReaction)), this, SLOT(currentTrackChanged(int,PlayerReaction)));
     }
@@ -803,14 +1347,20 @@ void Player::setPlaylist(PlaylistModel *playlist)
 
     currentTrackChanged(playlist->currentTrack(), NoReaction);
     mediaChanged();
+    updateCrossfade();
 
     emit playlistChanged();
 
     connect(playlist, SIGNAL(playbackModeChanged(PlaybackMode)), this, SIGNAL(playbackModeChanged(PlaybackMode)));
     connect(playlist, SIGNAL(trackAdded(int)), this, SIGNAL(trackAdded(int)));
-    connect(playlist, SIGNAL(trackRemoved(int)), this, SIGNAL(trackRemoved(int)));
+    connect(playlist, SIGNAL(trackRemoved(int,int)), this, SIGNAL(trackRemoved(int,int)));
     connect(playlist, SIGNAL(trackChanged(int)), this, SIGNAL(trackChanged(int)));
     connect(playlist, SIGNAL(tracksChanged()), this, SIGNAL(playlistChanged()));
+    connect(playlist, SIGNAL(tracksChanged()), this, SLOT(updateQueue()));
+    connect(playlist, SIGNAL(trackAdded(int)), this, SLOT(updateQueue()));
+    connect(playlist, SIGNAL(trackRemoved(int,int)), this, SLOT(updateQueue()));
+    connect(playlist, SIGNAL(playbackModeChanged(PlaybackMode)), this, SLOT(updateQueue()));
+    connect(playlist, SIGNAL(playbackModeChanged(PlaybackMode)), this, SLOT(updateCrossfade()));
     connect(playlist, SIGNAL(modified()), this, SLOT(mediaChanged()));
     connect(playlist, SIGNAL(currentTrackChanged(int,PlayerReaction)), this, SLOT(currentTrackChanged(int,PlayerReaction)));
 }
@@ -821,18 +1371,37 @@ void Player::setPosition(qint64 position)
     {
         m_mediaObject->seek(position);
 
+        if (m_crossfadeTrack >= 0)
+        {
+            scheduleCrossfade(m_mediaObject->totalTime() - position);
+        }
+
         emit positionChanged(position);
     }
 }
 
 void Player::setVolume(int volume)
 {
-    m_audioOutput->setVolume((qreal) volume / 100);
+    m_volume = qBound(0, volume, 100);
+
+    m_audioOutput->setVolume(((qreal) m_volume / 100) * gainFactor(url()));
+
+    if (m_fadeAudioOutput)
+    {
+        m_fadeAudioOutput->setVolume(((qreal) m_volume / 100) * gainFactor(KUrl(m_fadeMediaObject->currentSource().url())));
+    }
+
+    volumeChanged();
 }
 
 void Player::setAudioMuted(bool muted)
 {
     m_audioOutput->setMuted(muted);
+
+    if (m_fadeAudioOutput)
+    {
+        m_fadeAudioOutput->setMuted(muted);
+    }
 }
 
 void Player::setPlaybackMode(PlaybackMode mode)
@@ -845,9 +1414,28 @@ void Player::setPlaybackMode(PlaybackMode mode)
 
 void Player::setAspectRatio(AspectRatio ratio)
 {
+    if (ratio != Ratio4_3 && ratio != Ratio16_9 && ratio != FitToRatio)
+    {
+        ratio = AutomaticRatio;
+    }
+
     m_aspectRatio = ratio;
 
-    switch (ratio)
+    updateAspectRatio();
+
+    m_actions[AspectRatioMenuAction]->menu()->actions().at(static_cast<int>(ratio))->setChecked(true);
+
+    emit modified();
+}
+
+void Player::updateAspectRatio()
+{
+    if (!m_videoWidget)
+    {
+        return;
+    }
+
+    switch (m_aspectRatio)
     {
         case Ratio4_3:
             m_videoWidget->setAspectRatio(Phonon::VideoWidget::AspectRatio4_3);
@@ -864,28 +1452,28 @@ void Player::setAspectRatio(AspectRatio ratio)
         default:
             m_videoWidget->setAspectRatio(Phonon::VideoWidget::AspectRatioAuto);
 
-            ratio = AutomaticRatio;
-
             break;
     }
-
-    m_actions[AspectRatioMenuAction]->menu()->actions().at(static_cast<int>(ratio))->setChecked(true);
-
-    emit modified();
 }
 
 void Player::setVideoMode(bool mode)
 {
     m_videoMode = mode;
 
-    m_videoWidget->setParent(NULL);
-    m_videoWidget->hide();
+    if (m_videoWidget)
+    {
+        m_videoWidget->setParent(NULL);
+        m_videoWidget->hide();
+    }
 
-    if (isFullScreen())
+    if (isFullScreen() && m_videoWidget)
     {
         m_appletVideoWidget->setVideoWidget(NULL, false);
 
-        m_dialogVideoWidget->setVideoWidget(NULL, false);
+        if (m_dialogVideoWidget)
+        {
+            m_dialogVideoWidget->setVideoWidget(NULL, false);
+        }
 
         m_fullScreenUi.videoWidget->layout()->addWidget(m_videoWidget);
 
@@ -902,7 +1490,10 @@ void Player::setVideoMode(bool mode)
 
         if (m_videoMode)
         {
-            m_dialogVideoWidget->setVideoWidget(NULL, false);
+            if (m_dialogVideoWidget)
+            {
+                m_dialogVideoWidget->setVideoWidget(NULL, false);
+            }
 
             m_appletVideoWidget->setVideoWidget(m_videoWidget, mode);
         }
@@ -911,11 +1502,31 @@ void Player::setVideoMode(bool mode)
             m_appletVideoWidget->setVideoWidget(NULL, false);
             m_appletVideoWidget->hide();
 
-            m_dialogVideoWidget->setVideoWidget(m_videoWidget, mode);
+            if (m_dialogVideoWidget)
+            {
+                m_dialogVideoWidget->setVideoWidget(m_videoWidget, mode);
+            }
         }
     }
 
-    m_videoWidget->update();
+    updateVideoActivity();
+
+    if (m_videoWidget)
+    {
+        m_videoWidget->update();
+    }
+}
+
+void Player::updateVideoActivity()
+{
+    const bool active = (state() == PlayingState && isVideoAvailable());
+
+    m_appletVideoWidget->setActive(active);
+
+    if (m_dialogVideoWidget)
+    {
+        m_dialogVideoWidget->setActive(active);
+    }
 }
 
 void Player::setFullScreen(bool enable)
@@ -989,7 +1600,12 @@ void Player::setInhibitNotifications(bool inhibit)
 
 void Player::setBrightness(int value)
 {
-    m_videoWidget->setBrightness((value > 0)?(((qreal) value / 50) - 1):-1);
+    m_brightness = value;
+
+    if (m_videoWidget)
+    {
+        m_videoWidget->setBrightness((value > 0)?(((qreal) value / 50) - 1):-1);
+    }
 
     updateSliders();
 
@@ -998,7 +1614,12 @@ void Player::setBrightness(int value)
 
 void Player::setContrast(int value)
 {
-    m_videoWidget->setContrast((value > 0)?(((qreal) value / 50) - 1):-1);
+    m_contrast = value;
+
+    if (m_videoWidget)
+    {
+        m_videoWidget->setContrast((value > 0)?(((qreal) value / 50) - 1):-1);
+    }
 
     updateSliders();
 
@@ -1007,7 +1628,12 @@ void Player::setContrast(int value)
 
 void Player::setHue(int value)
 {
-    m_videoWidget->setHue((value > 0)?(((qreal) value / 50) - 1):-1);
+    m_hue = value;
+
+    if (m_videoWidget)
+    {
+        m_videoWidget->setHue((value > 0)?(((qreal) value / 50) - 1):-1);
+    }
 
     updateSliders();
 
@@ -1016,13 +1642,48 @@ void Player::setHue(int value)
 
 void Player::setSaturation(int value)
 {
-    m_videoWidget->setSaturation((value > 0)?(((qreal) value / 50) - 1):-1);
+    m_saturation = value;
+
+    if (m_videoWidget)
+    {
+        m_videoWidget->setSaturation((value > 0)?(((qreal) value / 50) - 1):-1);
+    }
 
     updateSliders();
 
     emit modified();
 }
 
+void Player::setTickInterval(QObject *client, int interval)
+{
+    if (interval > 0)
+    {
+        if (!m_tickIntervals.contains(client))
+        {
+            connect(client, SIGNAL(destroyed(QObject*)), this, SLOT(removeTickClient(QObject*)));
+        }
+
+        m_tickIntervals[client] = interval;
+    }
+    else if (m_tickIntervals.contains(client))
+    {
+        disconnect(client, SIGNAL(destroyed(QObject*)), this, SLOT(removeTickClient(QObject*)));
+
+        m_tickIntervals.remove(client);
+    }
+
+    updateTickInterval();
+}
+
+void Player::setCrossfadeDuration(int duration)
+{
+    m_crossfadeDuration = qMax(500, duration);
+
+    updateCrossfade();
+
+    emit modified();
+}
+
 QStringList Player::supportedMimeTypes() const
 {
     QStringList mimeTypes;
@@ -1119,27 +1780,50 @@ PlayerState Player::state() const
 
 int Player::volume() const
 {
-    return (m_audioOutput->volume() * 100);
+    return qRound((m_audioOutput->volume() / gainFactor(url())) * 100);
 }
 
 int Player::brightness() const
 {
-    return ((m_videoWidget->brightness() * 50) + 50);
+    return m_brightness;
 }
 
 int Player::contrast() const
 {
-    return ((m_videoWidget->contrast() * 50) + 50);
+    return m_contrast;
 }
 
 int Player::hue() const
 {
-    return ((m_videoWidget->hue() * 50) + 50);
+    return m_hue;
 }
 
 int Player::saturation() const
 {
-    return ((m_videoWidget->saturation() * 100) + 50);
+    return m_saturation;
+}
+
+qreal Player::gainFactor(const KUrl &url) const
+{
+    if (!MetaDataManager::hasGain(url))
+    {
+        return 1;
+    }
+
+    const qreal peak = MetaDataManager::peak(url);
+    qreal factor = pow(10, (MetaDataManager::gain(url) / 20));
+
+    return qMin(factor, ((peak > 0)?(1 / peak):1));
+}
+
+int Player::transitionLatency() const
+{
+    return m_transitionLatency;
+}
+
+int Player::crossfadeDuration() const
+{
+    return m_crossfadeDuration;
 }
 
 bool Player::isAudioMuted() const
@@ -21,6 +21,7 @@
 #ifndef MINIPLAYERPLAYER_HEADER
 #define MINIPLAYERPLAYER_HEADER
 
+#include <QtCore/QTime>
 #include <QtCore/QPointer>
 #include <QtGui/QAction>
 #include <QtGui/QSlider>
@@ -30,12 +31,15 @@
 #include <KNotificationRestrictions>
 
 #include <Phonon/AudioOutput>
+#include <Phonon/AudioDataOutput>
 #include <Phonon/MediaObject>
 #include <Phonon/MediaSource>
 #include <Phonon/VideoWidget>
 #include <Phonon/MediaController>
+#include <Phonon/VolumeFaderEffect>
 
 #include "Constants.h"
+#include "LoudnessAnalyzer.h"
 
 #include "ui_fullScreen.h"
 
@@ -71,6 +75,8 @@ class Player : public QObject
         int contrast() const;
         int hue() const;
         int saturation() const;
+        int transitionLatency() const;
+        int crossfadeDuration() const;
         bool isAudioMuted() const;
         bool isAudioAvailable() const;
         bool isVideoAvailable() const;
@@ -104,13 +110,24 @@ class Player : public QObject
         void setContrast(int value);
         void setHue(int value);
         void setSaturation(int value);
+        void setCrossfadeDuration(int duration);
+        void setTickInterval(QObject *client, int interval);
 
     protected:
         void timerEvent(QTimerEvent *event);
+        void connectMediaObject();
+        void initializeVideo();
+        void updateAspectRatio();
+        void updateTickInterval();
+        void finishAnalysis();
+        qreal gainFactor(const KUrl &url) const;
+        void startCrossfade();
+        void scheduleCrossfade(qint64 remaining);
+        void stopCrossfade();
         PlayerState translateState(Phonon::State state) const;
 
     protected slots:
-        void volumeChanged(qreal volume = -1);
+        void volumeChanged();
         void videoChanged();
         void mediaChanged();
         void availableChaptersChanged();
@@ -118,6 +135,11 @@ class Player : public QObject
         void availableSubtitlesChanged();
         void availableAnglesChanged();
         void availableTitlesChanged();
+        void updateChaptersMenu();
+        void updateAudioChannelsMenu();
+        void updateSubtitlesMenu();
+        void updateAnglesMenu();
+        void updateVideoPropertiesMenu();
         void currentTrackChanged(int track, PlayerReaction reaction = NoReaction);
         void stateChanged(Phonon::State state);
         void changeAspectRatio(QAction *action);
@@ -126,13 +148,33 @@ class Player : public QObject
         void changeSubtitles(QAction *action);
         void changeAngle(QAction *action);
         void trackFinished();
+        void enqueueNextTrack();
+        void updateQueue();
+        void sourceChanged(const Phonon::MediaSource &source);
+        void updateTransitionLatency();
+        void updateCrossfade();
+        void prepareCrossfade(qint32 remaining);
+        void updateGain();
+        void updateGain(const KUrl &url);
+        void analyzeData(const QMap<Phonon::AudioDataOutput::Channel, QVector<qint16> > &data);
         void updateSliders();
         void updateMetaData();
+        void removeTickClient(QObject *client);
+        void updateVideoActivity();
 
     private:
         Phonon::MediaObject *m_mediaObject;
+        Phonon::MediaObject *m_fadeMediaObject;
         Phonon::MediaController *m_mediaController;
         Phonon::AudioOutput *m_audioOutput;
+        Phonon::AudioOutput *m_fadeAudioOutput;
+        Phonon::VolumeFaderEffect *m_volumeFader;
+        Phonon::VolumeFaderEffect *m_fadeVolumeFader;
+        Phonon::AudioDataOutput *m_audioDataOutput;
+        Phonon::Path m_audioDataPath;
+        Phonon::Path m_audioPath;
+        Phonon::Path m_fadeAudioPath;
+        Phonon::Path m_videoPath;
         Phonon::VideoWidget *m_videoWidget;
         KNotificationRestrictions *m_notificationRestrictions;
         VideoWidget *m_appletVideoWidget;
@@ -149,10 +191,27 @@ class Player : public QObject
         QPointer<PlaylistModel> m_playlist;
         QMap<PlayerAction, QAction*> m_actions;
         QMap<MetaDataKey, Phonon::MetaData> m_keys;
+        QMap<QObject*, int> m_tickIntervals;
         AspectRatio m_aspectRatio;
+        LoudnessAnalyzer m_loudnessAnalyzer;
+        KUrl m_analyzedUrl;
+        QTime m_transitionTime;
+        qint64 m_transitionOffset;
         int m_stopSleepCookie;
         int m_hideFullScreenControlsTimer;
         int m_playPauseTimer;
+        int m_queuedTrack;
+        int m_crossfadeTrack;
+        int m_crossfadeDuration;
+        int m_startCrossfadeTimer;
+        int m_stopCrossfadeTimer;
+        int m_transitionLatency;
+        int m_volume;
+        int m_brightness;
+        int m_contrast;
+        int m_hue;
+        int m_saturation;
+        bool m_isAnalysisPending;
         bool m_inhibitNotifications;
         bool m_videoMode;
         Ui::fullScreen m_fullScreenUi;
@@ -163,10 +222,11 @@ class Player : public QObject
         void playlistChanged();
         void currentTrackChanged();
         void trackAdded(int track);
-        void trackRemoved(int track);
+        void trackRemoved(int track, int id);
         void trackChanged(int track);
         void durationChanged(qint64 duration);
         void positionChanged(qint64 position);
+        void tick(qint64 position);
         void volumeChanged(int volume);
         void audioMutedChanged(bool muted);
         void audioAvailableChanged(bool available);
@@ -0,0 +1,113 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "PlaylistCommand.h"
+#include "PlaylistModel.h"
+
+#include <KLocale>
+
+namespace MiniPlayer
+{
+
+PlaylistCommand::PlaylistCommand(PlaylistModel *playlist, PlaylistCommandType type, int position, const KUrl::List &tracks, const QList<int> &rows) : QUndoCommand(),
+    m_playlist(playlist),
+    m_tracks(tracks),
+    m_type(type),
+    m_position(position),
+    m_isApplied(true)
+{
+    switch (type)
+    {
+        case InsertTracksCommand:
+            setText(i18np("Add track", "Add %1 tracks", tracks.count()));
+
+            break;
+        case RemoveTracksCommand:
+            setText(i18np("Remove track", "Remove %1 tracks", tracks.count()));
+
+            break;
+        default:
+            setText(i18n("Reorder tracks"));
+
+            break;
+    }
+
+    if (type != PermuteTracksCommand)
+    {
+        return;
+    }
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (!m_ranges.isEmpty() && (m_ranges.last().first + m_ranges.last().second) == rows.at(i))
+        {
+            ++m_ranges.last().second;
+        }
+        else
+        {
+            m_ranges.append(qMakePair(rows.at(i), 1));
+        }
+    }
+
+    if ((m_ranges.count() * 2) > rows.count())
+    {
+        m_ranges.clear();
+        m_rows = rows;
+    }
+}
+
+void PlaylistCommand::undo()
+{
+    m_playlist->replayCommand(m_type, m_position, m_tracks, rows(), true);
+}
+
+void PlaylistCommand::redo()
+{
+    if (m_isApplied)
+    {
+        m_isApplied = false;
+
+        return;
+    }
+
+    m_playlist->replayCommand(m_type, m_position, m_tracks, rows(), false);
+}
+
+QList<int> PlaylistCommand::rows() const
+{
+    if (m_ranges.isEmpty())
+    {
+        return m_rows;
+    }
+
+    QList<int> rows;
+
+    for (int i = 0; i < m_ranges.count(); ++i)
+    {
+        for (int j = m_ranges.at(i).first; j < (m_ranges.at(i).first + m_ranges.at(i).second); ++j)
+        {
+            rows.append(j);
+        }
+    }
+
+    return rows;
+}
+
+}
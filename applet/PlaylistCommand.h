@@ -0,0 +1,56 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef MINIPLAYERPLAYLISTCOMMAND_HEADER
+#define MINIPLAYERPLAYLISTCOMMAND_HEADER
+
+#include <QtGui/QUndoCommand>
+
+#include <KUrl>
+
+#include "Constants.h"
+
+namespace MiniPlayer
+{
+
+class PlaylistModel;
+
+class PlaylistCommand : public QUndoCommand
+{
+    public:
+        explicit PlaylistCommand(PlaylistModel *playlist, PlaylistCommandType type, int position, const KUrl::List &tracks, const QList<int> &rows = QList<int>());
+
+        void undo();
+        void redo();
+        QList<int> rows() const;
+
+    private:
+        PlaylistModel *m_playlist;
+        KUrl::List m_tracks;
+        QList<int> m_rows;
+        QList<QPair<int, int> > m_ranges;
+        PlaylistCommandType m_type;
+        int m_position;
+        bool m_isApplied;
+};
+
+}
+
+#endif
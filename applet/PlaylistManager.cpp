@@ -22,14 +22,19 @@
 #include "PlaylistModel.h"
 #include "PlaylistWriter.h"
 #include "MetaDataManager.h"
+#include "Instrumentation.h"
 #include "Player.h"
 #include "VideoWidget.h"
 
+#include <QtCore/QTimer>
+
 #include <QtGui/QKeyEvent>
+#include <QtGui/QUndoStack>
 #include <QtGui/QClipboard>
 #include <QtGui/QHeaderView>
 #include <QtGui/QContextMenuEvent>
 
+#include <KIcon>
 #include <KMenu>
 #include <KMessageBox>
 #include <KFileDialog>
@@ -48,7 +53,7 @@ namespace MiniPlayer
 PlaylistManager::PlaylistManager(Player *parent) : QObject(parent),
     m_player(parent),
     m_dialog(NULL),
-    m_videoWidget(new VideoWidget(qobject_cast<QGraphicsWidget*>(m_player->parent()))),
+    m_videoWidget(NULL),
     m_size(QSize(600, 500)),
     m_selectedPlaylist(-1),
     m_removeTracks(0),
@@ -68,24 +73,33 @@ PlaylistManager::PlaylistManager(Player *parent) : QObject(parent),
     m_columns[DateColumn] = "date";
     m_columns[DurationColumn] = "duration";
 
-    m_videoWidget->hide();
+    ScopedTimer timer("PlaylistManager::PlaylistManager");
 
-    m_player->registerDialogVideoWidget(m_videoWidget);
-
-    foreach (Solid::Device device, Solid::Device::listFromType(Solid::DeviceInterface::OpticalDisc, QString()))
-    {
-        deviceAdded(device.udi());
-    }
+    QTimer::singleShot(0, this, SLOT(enumerateDevices()));
 
     connect(m_player, SIGNAL(requestDevicePlaylist(QString,KUrl::List)), this, SLOT(createDevicePlaylist(QString,KUrl::List)));
+    connect(m_player, SIGNAL(stateChanged(PlayerState)), this, SLOT(updatePlaylistsState()));
+    connect(m_player, SIGNAL(playlistChanged()), this, SLOT(updatePlaylistsState()));
     connect(m_player->action(OpenMenuAction)->menu(), SIGNAL(triggered(QAction*)), this, SLOT(openDisc(QAction*)));
     connect(m_player->action(PlaybackModeMenuAction)->menu(), SIGNAL(triggered(QAction*)), this, SLOT(playbackModeChanged(QAction*)));
     connect(Solid::DeviceNotifier::instance(), SIGNAL(deviceAdded(QString)), this, SLOT(deviceAdded(QString)));
     connect(Solid::DeviceNotifier::instance(), SIGNAL(deviceRemoved(QString)), this, SLOT(deviceRemoved(QString)));
 }
 
+void PlaylistManager::enumerateDevices()
+{
+    ScopedTimer timer("PlaylistManager::enumerateDevices");
+
+    foreach (Solid::Device device, Solid::Device::listFromType(Solid::DeviceInterface::OpticalDisc, QString()))
+    {
+        deviceAdded(device.udi());
+    }
+}
+
 void PlaylistManager::timerEvent(QTimerEvent *event)
 {
+    Instrumentation::recordWakeup("PlaylistManager");
+
     if (event->timerId() == m_removeTracks)
     {
         m_removeTracks = 0;
@@ -157,6 +171,7 @@ void PlaylistManager::visiblePlaylistChanged(int position)
     }
 
     PlaylistModel *playlist = m_playlists[m_playlistsOrder[position]];
+    playlist->load();
 
     m_playlistUi.playlistView->setModel(playlist);
     m_playlistUi.playlistView->horizontalHeader()->setMovable(true);
@@ -171,6 +186,8 @@ void PlaylistManager::visiblePlaylistChanged(int position)
 
     m_playlistUi.playlistView->scrollTo(playlist->index(playlist->currentTrack(), 0), QAbstractItemView::PositionAtCenter);
 
+    updatePlaylistsState();
+
     emit modified();
 }
 
@@ -310,6 +327,8 @@ void PlaylistManager::filterPlaylist()
 
 void PlaylistManager::filterPlaylist(const QString &text)
 {
+    ScopedTimer timer("PlaylistManager::filterPlaylist");
+
     PlaylistModel *playlist = m_playlists[visiblePlaylist()];
     QList<int> visibleSections;
 
@@ -374,6 +393,55 @@ void PlaylistManager::renamePlaylist(int position)
     emit modified();
 }
 
+void PlaylistManager::watchDirectory(int position)
+{
+    if (position >= m_playlists.count())
+    {
+        return;
+    }
+
+    if (position < 0)
+    {
+        position = m_selectedPlaylist;
+    }
+
+    PlaylistModel *playlist = m_playlists[m_playlistsOrder[position]];
+
+    if (playlist->isReadOnly())
+    {
+        return;
+    }
+
+    const QString directory = KFileDialog::getExistingDirectory(KUrl(playlist->watchedDirectory()), m_dialog, i18n("Synchronize with folder"));
+
+    if (directory.isEmpty())
+    {
+        return;
+    }
+
+    playlist->setWatchedDirectory(directory);
+
+    emit modified();
+}
+
+void PlaylistManager::unwatchDirectory(int position)
+{
+    if (position >= m_playlists.count())
+    {
+        return;
+    }
+
+    if (position < 0)
+    {
+        position = m_selectedPlaylist;
+    }
+
+    m_playlists[m_playlistsOrder[position]]->setWatchedDirectory(QString());
+    m_playlists[m_playlistsOrder[position]]->setSourceFile(QString());
+
+    emit modified();
+}
+
 void PlaylistManager::removePlaylist(int position)
 {
     if (position >= m_playlists.count())
@@ -480,28 +548,39 @@ void PlaylistManager::trackChanged()
 
 void PlaylistManager::moveUpTrack()
 {
-    PlaylistModel *playlist = m_playlists[visiblePlaylist()];
-    const KUrl url(m_playlistUi.playlistView->currentIndex().data(Qt::UserRole).toUrl());
-    const int row = m_playlistUi.playlistView->currentIndex().row();
+    const QList<int> rows = selectedTracks();
 
-    playlist->removeTrack(row);
-    playlist->addTrack((row - 1), url);
+    if (rows.isEmpty() || rows.first() == 0)
+    {
+        return;
+    }
 
-    m_playlistUi.playlistView->setCurrentIndex(playlist->index((row - 1), 0));
+    m_playlists[visiblePlaylist()]->moveTracks(rows, (rows.first() - 1));
 
-    updateActions();
+    selectTracks((rows.first() - 1), rows.count());
 }
 
 void PlaylistManager::moveDownTrack()
 {
     PlaylistModel *playlist = m_playlists[visiblePlaylist()];
-    const KUrl url(m_playlistUi.playlistView->currentIndex().data(Qt::UserRole).toUrl());
-    const int row = m_playlistUi.playlistView->currentIndex().row();
+    const QList<int> rows = selectedTracks();
 
-    playlist->removeTrack(row);
-    playlist->addTrack((row + 1), url);
+    if (rows.isEmpty() || rows.last() >= (playlist->trackCount() - 1))
+    {
+        return;
+    }
+
+    playlist->moveTracks(rows, (rows.last() + 2));
+
+    selectTracks((rows.last() + 2 - rows.count()), rows.count());
+}
 
-    m_playlistUi.playlistView->setCurrentIndex(playlist->index((row + 1), 0));
+void PlaylistManager::selectTracks(int row, int count)
+{
+    PlaylistModel *playlist = m_playlists[visiblePlaylist()];
+
+    m_playlistUi.playlistView->setCurrentIndex(playlist->index(row, 0));
+    m_playlistUi.playlistView->selectionModel()->select(QItemSelection(playlist->index(row, 0), playlist->index((row + count - 1), 0)), (QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows));
 
     updateActions();
 }
@@ -577,7 +656,7 @@ void PlaylistManager::editTrack(QAction *action)
 
 void PlaylistManager::copyTrack(QAction *action)
 {
-    PlaylistModel *sourcePlaylist = m_playlists[currentPlaylist()];
+    PlaylistModel *sourcePlaylist = m_playlists[visiblePlaylist()];
 
     if (!sourcePlaylist)
     {
@@ -585,11 +664,11 @@ void PlaylistManager::copyTrack(QAction *action)
     }
 
     KUrl::List urls;
-    const QModelIndexList selectedRows = m_playlistUi.playlistView->selectionModel()->selectedRows();
+    const QList<int> rows = selectedTracks();
 
-    for (int i = 0; i < selectedRows.count(); ++i)
+    for (int i = 0; i < rows.count(); ++i)
     {
-        urls.append(sourcePlaylist->track(selectedRows.at(i).row()));
+        urls.append(sourcePlaylist->track(rows.at(i)));
     }
 
     int target = action->data().toInt();
@@ -613,7 +692,7 @@ void PlaylistManager::copyTrack(QAction *action)
         return;
     }
 
-    targetPlaylist->addTracks(urls);
+    targetPlaylist->insertTracks(urls);
 }
 
 void PlaylistManager::saveTrack()
@@ -643,16 +722,27 @@ void PlaylistManager::updateActions()
 
     PlaylistModel *playlist = m_playlists[visiblePlaylist()];
 
-    m_player->action(PlaybackModeMenuAction)->menu()->actions().at(static_cast<int>(playlist->playbackMode()))->setChecked(true);
+    const QList<QAction*> playbackModeActions = m_player->action(PlaybackModeMenuAction)->menu()->actions();
+
+    for (int i = 0; i < playbackModeActions.count(); ++i)
+    {
+        if (playbackModeActions.at(i)->data().toInt() == static_cast<int>(playlist->playbackMode()))
+        {
+            playbackModeActions.at(i)->setChecked(true);
+
+            break;
+        }
+    }
 
     QModelIndexList selectedIndexes = m_playlistUi.playlistView->selectionModel()->selectedIndexes();
+    const QList<int> selectedRows = selectedTracks();
     bool hasTracks = playlist->trackCount();
 
     m_playlistUi.addButton->setEnabled(!playlist->isReadOnly());
     m_playlistUi.removeButton->setEnabled(!selectedIndexes.isEmpty());
     m_playlistUi.editButton->setEnabled(!selectedIndexes.isEmpty() && !playlist->isReadOnly());
-    m_playlistUi.moveUpButton->setEnabled((playlist->trackCount() > 1) && !selectedIndexes.isEmpty() && selectedIndexes.first().row() != 0);
-    m_playlistUi.moveDownButton->setEnabled((playlist->trackCount() > 1) && !selectedIndexes.isEmpty() && selectedIndexes.last().row() != (playlist->trackCount() - 1));
+    m_playlistUi.moveUpButton->setEnabled((playlist->trackCount() > 1) && !selectedRows.isEmpty() && selectedRows.first() != 0);
+    m_playlistUi.moveDownButton->setEnabled((playlist->trackCount() > 1) && !selectedRows.isEmpty() && selectedRows.last() != (playlist->trackCount() - 1));
     m_playlistUi.clearButton->setEnabled(hasTracks && !playlist->isReadOnly());
     m_playlistUi.playbackModeButton->setEnabled(hasTracks);
     m_playlistUi.exportButton->setEnabled(hasTracks && !playlist->isReadOnly());
@@ -737,6 +827,11 @@ void PlaylistManager::showDialog(const QPoint &position)
 
         m_playlistUi.setupUi(m_dialog);
 
+        m_videoWidget = new VideoWidget(qobject_cast<QGraphicsWidget*>(m_player->parent()));
+        m_videoWidget->hide();
+
+        m_player->registerDialogVideoWidget(m_videoWidget);
+
         m_playlistUi.graphicsView->setScene(new QGraphicsScene(this));
         m_playlistUi.graphicsView->scene()->addItem(m_videoWidget);
         m_playlistUi.graphicsView->installEventFilter(this);
@@ -851,6 +946,8 @@ void PlaylistManager::setCurrentPlaylist(int id)
         id = visiblePlaylist();
     }
 
+    m_playlists[id]->load();
+
     m_player->setPlaylist(m_playlists[id]);
 
     if (m_dialog)
@@ -982,6 +1079,27 @@ QList<int> PlaylistManager::playlists() const
     return m_playlistsOrder;
 }
 
+QList<int> PlaylistManager::selectedTracks() const
+{
+    QList<int> rows;
+
+    if (!m_dialog || !m_playlistUi.playlistView->selectionModel())
+    {
+        return rows;
+    }
+
+    const QModelIndexList selectedRows = m_playlistUi.playlistView->selectionModel()->selectedRows();
+
+    for (int i = 0; i < selectedRows.count(); ++i)
+    {
+        rows.append(selectedRows.at(i).row());
+    }
+
+    qSort(rows);
+
+    return rows;
+}
+
 QStringList PlaylistManager::columnsOrder() const
 {
     return m_columnsOrder;
@@ -1007,6 +1125,24 @@ QByteArray PlaylistManager::headerState() const
     return (m_dialog?m_playlistUi.playlistView->horizontalHeader()->saveState():m_headerState);
 }
 
+void PlaylistManager::updatePlaylistsState()
+{
+    const int current = currentPlaylist();
+    const PlayerState state = m_player->state();
+    QMap<int, PlaylistModel*>::iterator iterator;
+
+    for (iterator = m_playlists.begin(); iterator != m_playlists.end(); ++iterator)
+    {
+        iterator.value()->setPlayerState(state);
+        iterator.value()->setCurrent(iterator.key() == current);
+    }
+}
+
+void PlaylistManager::showError(const QString &error)
+{
+    KMessageBox::error(NULL, error);
+}
+
 PlayerState PlaylistManager::state() const
 {
     return m_player->state();
@@ -1026,6 +1162,9 @@ int PlaylistManager::createPlaylist(const QString &title, const KUrl::List &trac
 
     m_playlists[id] = new PlaylistModel(this, id, title, source);
 
+    connect(m_playlists[id], SIGNAL(tracksRemoved(KUrl::List)), this, SLOT(removeTracks(KUrl::List)));
+    connect(m_playlists[id], SIGNAL(errorOccured(QString)), this, SLOT(showError(QString)));
+
     int position = qMin(m_playlists.count(), (m_playlistsOrder.indexOf(visiblePlaylist()) + 1));
 
     m_playlistsOrder.insert(position, id);
@@ -1052,6 +1191,8 @@ int PlaylistManager::createPlaylist(const QString &title, const KUrl::List &trac
     connect(m_playlists[id], SIGNAL(modified()), this, SIGNAL(modified()));
     connect(m_playlists[id], SIGNAL(dataChanged(QModelIndex,QModelIndex)), this, SLOT(trackChanged()));
 
+    updatePlaylistsState();
+
     return id;
 }
 
@@ -1103,6 +1244,21 @@ bool PlaylistManager::eventFilter(QObject *object, QEvent *event)
                     removeTrack();
                 }
             }
+            else if (keyEvent->matches(QKeySequence::Undo) || keyEvent->matches(QKeySequence::Redo))
+            {
+                QUndoStack *undoStack = m_playlists[visiblePlaylist()]->undoStack();
+
+                if (keyEvent->matches(QKeySequence::Undo))
+                {
+                    undoStack->undo();
+                }
+                else
+                {
+                    undoStack->redo();
+                }
+
+                updateActions();
+            }
             else
             {
                 QCoreApplication::sendEvent(m_player->parent(), keyEvent);
@@ -1232,6 +1388,13 @@ bool PlaylistManager::eventFilter(QObject *object, QEvent *event)
             {
                 menu.addSeparator();
                 menu.addAction(KIcon("edit-rename"), i18n("Rename playlist..."), this, SLOT(renamePlaylist()));
+                menu.addAction(KIcon("folder-sync"), i18n("Synchronize with folder..."), this, SLOT(watchDirectory()));
+
+                if (!m_playlists[m_playlistsOrder[m_selectedPlaylist]]->watchedDirectory().isEmpty() || !m_playlists[m_playlistsOrder[m_selectedPlaylist]]->sourceFile().isEmpty())
+                {
+                    menu.addAction(KIcon("folder"), i18n("Stop synchronizing"), this, SLOT(unwatchDirectory()));
+                }
+
                 menu.addSeparator();
                 menu.addAction(KIcon("document-close"), i18n("Close playlist"), this, SLOT(removePlaylist()));
             }
@@ -1278,7 +1441,8 @@ bool PlaylistManager::eventFilter(QObject *object, QEvent *event)
 
             if (dropEvent->mimeData()->hasUrls())
             {
-                int tab = m_playlistUi.tabBar->tabAt(dropEvent->pos());
+                const int tab = m_playlistUi.tabBar->tabAt(dropEvent->pos());
+                int id = m_playlistsOrder.value(tab, -1);
 
                 if (tab < 0)
                 {
@@ -1286,13 +1450,16 @@ bool PlaylistManager::eventFilter(QObject *object, QEvent *event)
 
                     if (!title.isEmpty())
                     {
-                        tab = createPlaylist(title);
+                        id = createPlaylist(title);
                     }
                 }
 
-                if (tab >= 0 && m_playlists[m_playlistsOrder[tab]])
+                if (id >= 0 && m_playlists.value(id))
                 {
-                    m_playlists[m_playlistsOrder[tab]]->addTracks(KUrl::List(dropEvent->mimeData()->urls()));
+                    if (!m_playlists[id]->copyTracks(dropEvent->mimeData()))
+                    {
+                        m_playlists[id]->addTracks(KUrl::List(dropEvent->mimeData()->urls()));
+                    }
 
                     return true;
                 }
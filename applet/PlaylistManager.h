@@ -43,7 +43,6 @@ class PlaylistManager : public QObject
         explicit PlaylistManager(Player *parent);
 
         void addTracks(const KUrl::List &tracks, int index = -1, PlayerReaction reaction = NoReaction);
-        void removeTracks(const KUrl::List &tracks);
         PlaylistModel* playlist(int id) const;
         QList<int> playlists() const;
         QStringList columnsOrder() const;
@@ -62,6 +61,7 @@ class PlaylistManager : public QObject
     public slots:
         void showDialog(const QPoint &position);
         void closeDialog();
+        void removeTracks(const KUrl::List &tracks);
         void setCurrentPlaylist(int id);
         void setDialogSize(const QSize &size);
         void setPlaylistsOrder(const QList<int> &order);
@@ -73,6 +73,8 @@ class PlaylistManager : public QObject
 
     protected:
         void timerEvent(QTimerEvent *event);
+        void selectTracks(int row, int count);
+        QList<int> selectedTracks() const;
 
     protected slots:
         void columnsOrderChanged();
@@ -80,6 +82,7 @@ class PlaylistManager : public QObject
         void playbackModeChanged(QAction *action);
         void toggleColumnVisibility(QAction *action);
         void openDisc(QAction *action);
+        void enumerateDevices();
         void deviceAdded(const QString &udi);
         void deviceRemoved(const QString &udi);
         void createDevicePlaylist(const QString &udi, const KUrl::List &tracks);
@@ -87,6 +90,8 @@ class PlaylistManager : public QObject
         void filterPlaylist();
         void filterPlaylist(const QString &text);
         void renamePlaylist(int id = -1);
+        void watchDirectory(int position = -1);
+        void unwatchDirectory(int position = -1);
         void removePlaylist(int id = -1);
         void exportPlaylist();
         void newPlaylist();
@@ -105,6 +110,8 @@ class PlaylistManager : public QObject
         void updateTheme();
         void updateLabel();
         void updateVideoView();
+        void updatePlaylistsState();
+        void showError(const QString &error);
 
     private:
         Player *m_player;
@@ -19,12 +19,22 @@
 ***********************************************************************************/
 
 #include "PlaylistModel.h"
+#include "PlaylistCommand.h"
+#include "PlaylistSynchronizer.h"
 #include "PlaylistReader.h"
-#include "PlaylistManager.h"
 #include "MetaDataManager.h"
+#include "Instrumentation.h"
+#include "IdleManager.h"
 
+#include <QtCore/QVector>
 #include <QtCore/QDateTime>
 #include <QtCore/QFileInfo>
+#include <QtCore/QDataStream>
+#include <QtCore/QTimer>
+#include <QtCore/QTimerEvent>
+#include <QtCore/QCoreApplication>
+
+#include <QtGui/QUndoStack>
 
 #include <KLocale>
 #include <KMimeType>
@@ -33,19 +43,39 @@
 namespace MiniPlayer
 {
 
-PlaylistModel::PlaylistModel(PlaylistManager *parent, int id, const QString &title, PlaylistSource source) : QAbstractTableModel(parent),
-    m_manager(parent),
+int PlaylistModel::m_trackIdCounter = 0;
+
+PlaylistModel::PlaylistModel(QObject *parent, int id, const QString &title, PlaylistSource source) : QAbstractTableModel(parent),
+    m_undoStack(new QUndoStack(this)),
+    m_directorySynchronizer(NULL),
+    m_fileSynchronizer(NULL),
     m_title(title),
     m_creationDate(QDateTime::currentDateTime()),
     m_modificationDate(QDateTime::currentDateTime()),
     m_playbackMode(SequentialMode),
     m_source(source),
+    m_playerState(StoppedState),
     m_id(id),
-    m_currentTrack(-1)
+    m_currentTrack(-1),
+    m_currentTrackId(-1),
+    m_shuffleAnchor(-1),
+    m_shuffleSteps(0),
+    m_validTrackRows(0),
+    m_pendingCurrentTrack(-1),
+    m_revalidateTimer(0),
+    m_revalidatePosition(0),
+    m_isCurrent(false),
+    m_isLoaded(true),
+    m_isRewinding(false),
+    m_isReplaying(false),
+    m_isSynchronizing(false),
+    m_shuffleValid(false)
 {
     setSupportedDragActions(Qt::MoveAction);
     setPlaybackMode(m_playbackMode);
 
+    m_undoStack->setUndoLimit(50);
+
     connect(this, SIGNAL(modified()), this, SIGNAL(layoutChanged()));
     connect(this, SIGNAL(modified()), this, SLOT(updateModificationDate()));
     connect(MetaDataManager::instance(), SIGNAL(urlChanged(KUrl)), this, SLOT(metaDataChanged(KUrl)));
@@ -53,7 +83,14 @@ PlaylistModel::PlaylistModel(PlaylistManager *parent, int id, const QString &tit
 
 void PlaylistModel::addTrack(int position, const KUrl &url)
 {
+    recordCommand(InsertTracksCommand, position, KUrl::List(url));
+
     m_tracks.insert(position, url);
+    m_trackIds.insert(position, createTrackId());
+
+    invalidateTrackRows(position);
+
+    insertShuffleTrack(m_trackIds.at(position));
 
     if (position <= m_currentTrack)
     {
@@ -71,33 +108,226 @@ void PlaylistModel::removeTrack(int position)
         return;
     }
 
-    m_manager->removeTracks(KUrl::List(m_tracks.at(position)));
+    recordCommand(RemoveTracksCommand, position, KUrl::List(m_tracks.at(position)));
+
+    emit tracksRemoved(KUrl::List(m_tracks.at(position)));
+
+    const int id = m_trackIds.takeAt(position);
 
     m_tracks.removeAt(position);
+    m_trackRows.remove(id);
+
+    invalidateTrackRows(position);
+
+    removeShuffleTrack(id);
 
     if (position <= m_currentTrack)
     {
-        setCurrentTrack((m_currentTrack - 1), ((position == m_currentTrack && (m_manager->state() != StoppedState && isCurrent()))?StopReaction:NoReaction));
+        setCurrentTrack((m_currentTrack - 1), ((position == m_currentTrack && (m_playerState != StoppedState && isCurrent()))?StopReaction:NoReaction));
     }
     else
     {
         setCurrentTrack(m_currentTrack);
     }
 
-    emit trackRemoved(position);
+    emit trackRemoved(position, id);
     emit modified();
 }
 
 void PlaylistModel::addTracks(const KUrl::List &tracks, int position, PlayerReaction reaction)
 {
+    load();
+
     if (position == -1)
     {
         position = m_tracks.count();
     }
 
+    if (m_isLoaded && m_tracks.isEmpty() && tracks.count() == 1 && tracks.first().isLocalFile() && !isReadOnly())
+    {
+        KMimeType::Ptr mimeType = KMimeType::findByUrl(tracks.first());
+
+        if (mimeType->is("audio/x-scpls") || mimeType->is("audio/x-mpegurl") || mimeType->is("application/xspf+xml") || mimeType->is("audio/x-ms-asx"))
+        {
+            setSourceFile(tracks.first().toLocalFile());
+        }
+    }
+
     new PlaylistReader(this, tracks, position, reaction);
 }
 
+void PlaylistModel::setPendingTracks(const QStringList &tracks, int currentTrack)
+{
+    m_pendingTracks = tracks;
+    m_pendingCurrentTrack = currentTrack;
+    m_isLoaded = false;
+}
+
+void PlaylistModel::load()
+{
+    if (m_isLoaded)
+    {
+        return;
+    }
+
+    ScopedTimer timer("PlaylistModel::load");
+
+    const KUrl::List tracks(m_pendingTracks);
+
+    m_pendingTracks.clear();
+    m_isLoaded = true;
+
+    disconnect(this, SIGNAL(modified()), this, SLOT(updateModificationDate()));
+
+    restoreTracks(tracks, m_pendingCurrentTrack);
+
+    connect(this, SIGNAL(modified()), this, SLOT(updateModificationDate()));
+
+    if (!m_watchedDirectory.isEmpty() && !m_directorySynchronizer)
+    {
+        m_directorySynchronizer = new PlaylistSynchronizer(this, m_watchedDirectory);
+    }
+
+    if (!m_sourceFile.isEmpty() && !m_fileSynchronizer)
+    {
+        m_fileSynchronizer = new PlaylistSynchronizer(this, m_sourceFile, FileSynchronization);
+    }
+}
+
+void PlaylistModel::restoreTracks(const KUrl::List &tracks, int currentTrack)
+{
+    ScopedTimer timer("PlaylistModel::restoreTracks");
+
+    beginResetModel();
+
+    m_tracks = tracks;
+    m_trackIds.clear();
+    m_trackIds.reserve(tracks.count());
+
+    for (int i = 0; i < tracks.count(); ++i)
+    {
+        m_trackIds.append(createTrackId());
+    }
+
+    m_trackRows.clear();
+
+    m_validTrackRows = 0;
+
+    invalidateShuffle();
+
+    m_undoStack->clear();
+
+    endResetModel();
+
+    m_revalidatePosition = 0;
+
+    scheduleRevalidation();
+
+    setCurrentTrack(currentTrack);
+
+    emit tracksChanged();
+}
+
+void PlaylistModel::timerEvent(QTimerEvent *event)
+{
+    Instrumentation::recordWakeup("PlaylistModel");
+
+    if (event->timerId() != m_revalidateTimer)
+    {
+        killTimer(event->timerId());
+
+        return;
+    }
+
+    if (IdleManager::isIdle())
+    {
+        killTimer(m_revalidateTimer);
+
+        m_revalidateTimer = 0;
+
+        scheduleRevalidation();
+
+        return;
+    }
+
+    ScopedTimer timer("PlaylistModel::revalidateTracks");
+
+    const int end = qMin(m_tracks.count(), (m_revalidatePosition + 100));
+    KUrl::List unresolvedTracks;
+    QList<int> staleTracks;
+
+    for (int i = m_revalidatePosition; i < end; ++i)
+    {
+        const KUrl url = m_tracks.at(i);
+
+        if (url.isLocalFile())
+        {
+            if (!QFileInfo(url.toLocalFile()).exists())
+            {
+                staleTracks.append(i);
+
+                continue;
+            }
+
+            const QString mimeType = KMimeType::findByUrl(url)->name();
+
+            if (mimeType.indexOf("video/") == -1 && mimeType.indexOf("audio/") == -1 && mimeType != "application/ogg")
+            {
+                staleTracks.append(i);
+
+                continue;
+            }
+        }
+
+        if (!MetaDataManager::isAvailable(url))
+        {
+            unresolvedTracks.append(url);
+        }
+    }
+
+    m_isSynchronizing = true;
+
+    removeTracks(staleTracks);
+
+    m_isSynchronizing = false;
+
+    m_revalidatePosition = (end - staleTracks.count());
+
+    if (!unresolvedTracks.isEmpty())
+    {
+        MetaDataManager::resolveTracks(unresolvedTracks);
+    }
+
+    if (m_revalidatePosition >= m_tracks.count())
+    {
+        killTimer(m_revalidateTimer);
+
+        m_revalidateTimer = 0;
+
+        if (IdleManager::instance())
+        {
+            disconnect(IdleManager::instance(), SIGNAL(idleChanged(bool)), this, SLOT(scheduleRevalidation()));
+        }
+    }
+}
+
+void PlaylistModel::scheduleRevalidation()
+{
+    if (m_revalidateTimer || m_revalidatePosition >= m_tracks.count())
+    {
+        return;
+    }
+
+    if (IdleManager::isIdle())
+    {
+        connect(IdleManager::instance(), SIGNAL(idleChanged(bool)), this, SLOT(scheduleRevalidation()), Qt::UniqueConnection);
+
+        return;
+    }
+
+    m_revalidateTimer = startTimer(50);
+}
+
 void PlaylistModel::metaDataChanged(const KUrl &url)
 {
     if (!m_tracks.contains(url))
@@ -122,9 +352,53 @@ void PlaylistModel::metaDataChanged(const KUrl &url)
 
 void PlaylistModel::processedTracks(const KUrl::List &tracks, int position, PlayerReaction reaction)
 {
-    for (int i = (tracks.count() - 1); i >= 0; --i)
+    insertTracks(tracks, position, reaction);
+
+    MetaDataManager::resolveTracks(tracks);
+}
+
+void PlaylistModel::insertTracks(const KUrl::List &tracks, int position, PlayerReaction reaction)
+{
+    if (tracks.isEmpty())
+    {
+        return;
+    }
+
+    ScopedTimer timer("PlaylistModel::insertTracks");
+
+    load();
+
+    if (position < 0 || position > m_tracks.count())
+    {
+        position = m_tracks.count();
+    }
+
+    recordCommand(InsertTracksCommand, position, tracks);
+
+    QList<int> trackIds;
+    trackIds.reserve(tracks.count());
+
+    for (int i = 0; i < tracks.count(); ++i)
+    {
+        trackIds.append(createTrackId());
+    }
+
+    if (position == m_tracks.count())
+    {
+        m_tracks.append(tracks);
+        m_trackIds.append(trackIds);
+    }
+    else
+    {
+        m_tracks = (m_tracks.mid(0, position) + tracks + m_tracks.mid(position));
+        m_trackIds = (m_trackIds.mid(0, position) + trackIds + m_trackIds.mid(position));
+    }
+
+    invalidateTrackRows(position);
+
+    for (int i = 0; i < trackIds.count(); ++i)
     {
-        m_tracks.insert(position, tracks.at(i));
+        insertShuffleTrack(trackIds.at(i));
     }
 
     if (reaction == PlayReaction)
@@ -143,9 +417,15 @@ void PlaylistModel::processedTracks(const KUrl::List &tracks, int position, Play
         }
     }
 
-    MetaDataManager::resolveTracks(tracks);
+    if (tracks.count() == 1)
+    {
+        emit trackAdded(position);
+    }
+    else
+    {
+        emit tracksChanged();
+    }
 
-    emit tracksChanged();
     emit modified();
 }
 
@@ -167,9 +447,17 @@ void PlaylistModel::clear()
         return;
     }
 
-    m_manager->removeTracks(m_tracks);
+    recordCommand(RemoveTracksCommand, 0, m_tracks);
+
+    emit tracksRemoved(m_tracks);
 
     m_tracks.clear();
+    m_trackIds.clear();
+    m_trackRows.clear();
+
+    m_validTrackRows = 0;
+
+    invalidateShuffle();
 
     emit tracksChanged();
     emit modified();
@@ -182,11 +470,20 @@ void PlaylistModel::shuffle()
         return;
     }
 
-    const KUrl url = m_tracks.value(m_currentTrack);
+    const int id = trackId(m_currentTrack);
+    QList<int> rows;
+    rows.reserve(m_tracks.count());
+
+    for (int i = 0; i < m_tracks.count(); ++i)
+    {
+        rows.append(i);
+    }
+
+    KRandomSequence().randomize(rows);
 
-    KRandomSequence().randomize(m_tracks);
+    reorderTracks(rows);
 
-    setCurrentTrack(findTrack(url));
+    setCurrentTrack(qMax(0, trackRow(id)));
 
     emit tracksChanged();
     emit modified();
@@ -194,24 +491,26 @@ void PlaylistModel::shuffle()
 
 void PlaylistModel::sort(int column, Qt::SortOrder order)
 {
+    ScopedTimer timer("PlaylistModel::sort");
+
     if (m_tracks.count() < 2)
     {
         return;
     }
 
-    QMultiMap<QString, KUrl> keyMap;
-    QMultiMap<qint64, KUrl> durationMap;
-    KUrl::List tracks;
-    const KUrl url = m_tracks.value(m_currentTrack);
+    QMultiMap<QString, int> keyMap;
+    QMultiMap<qint64, int> durationMap;
+    QList<int> rows;
+    const int id = trackId(m_currentTrack);
 
     if (column == DurationColumn)
     {
         for (int i = 0; i < m_tracks.count(); ++i)
         {
-            durationMap.insert(MetaDataManager::duration(m_tracks.at(i)), m_tracks.at(i));
+            durationMap.insert(MetaDataManager::duration(m_tracks.at(i)), i);
         }
 
-        tracks = durationMap.values();
+        rows = durationMap.values();
     }
     else if (column > FileNameColumn && column < DurationColumn)
     {
@@ -219,36 +518,32 @@ void PlaylistModel::sort(int column, Qt::SortOrder order)
 
         for (int i = 0; i < m_tracks.count(); ++i)
         {
-            keyMap.insert(MetaDataManager::metaData(m_tracks.at(i), key), m_tracks.at(i));
+            keyMap.insert(MetaDataManager::metaData(m_tracks.at(i), key), i);
         }
 
-        tracks = keyMap.values();
+        rows = keyMap.values();
     }
     else
     {
         for (int i = 0; i < m_tracks.count(); ++i)
         {
-            keyMap.insert(m_tracks.at(i).pathOrUrl(), m_tracks.at(i));
+            keyMap.insert(m_tracks.at(i).pathOrUrl(), i);
         }
 
-        tracks = keyMap.values();
+        rows = keyMap.values();
     }
 
     if (order == Qt::AscendingOrder)
     {
-        KUrl::List items;
-
-        for (int i = (tracks.count() - 1); i >= 0; --i)
+        for (int i = 0; i < (rows.count() / 2); ++i)
         {
-            items.append(tracks.at(i));
+            rows.swap(i, (rows.count() - i - 1));
         }
-
-        tracks = items;
     }
 
-    m_tracks = tracks;
+    reorderTracks(rows);
 
-    setCurrentTrack(findTrack(url));
+    setCurrentTrack(qMax(0, trackRow(id)));
 
     emit tracksChanged();
 }
@@ -261,7 +556,7 @@ void PlaylistModel::next(PlayerReaction reaction)
     }
     else if (m_playbackMode == RandomMode)
     {
-        setCurrentTrack(randomTrack(), reaction);
+        setCurrentTrack(nextTrack(), reaction);
     }
     else
     {
@@ -277,7 +572,25 @@ void PlaylistModel::previous(PlayerReaction reaction)
     }
     else if (m_playbackMode == RandomMode)
     {
-        setCurrentTrack(randomTrack(), reaction);
+        int track = -1;
+
+        while (track < 0 && !m_history.isEmpty())
+        {
+            track = trackRow(m_history.takeLast());
+        }
+
+        if (track < 0)
+        {
+            updateShuffle();
+
+            track = trackRow(m_shufflePrevious.value(m_currentTrackId, m_shuffleAnchor));
+        }
+
+        m_isRewinding = true;
+
+        setCurrentTrack(track, reaction);
+
+        m_isRewinding = false;
     }
     else
     {
@@ -292,6 +605,57 @@ void PlaylistModel::setTitle(const QString &title)
     emit modified();
 }
 
+void PlaylistModel::setWatchedDirectory(const QString &directory)
+{
+    if (directory == m_watchedDirectory)
+    {
+        return;
+    }
+
+    if (m_directorySynchronizer)
+    {
+        m_directorySynchronizer->deleteLater();
+        m_directorySynchronizer = NULL;
+    }
+
+    m_watchedDirectory = directory;
+
+    if (!m_watchedDirectory.isEmpty() && m_isLoaded)
+    {
+        m_directorySynchronizer = new PlaylistSynchronizer(this, m_watchedDirectory);
+    }
+
+    emit modified();
+}
+
+void PlaylistModel::setSourceFile(const QString &path, const QByteArray &hash)
+{
+    if (path == m_sourceFile && hash == m_sourceHash)
+    {
+        return;
+    }
+
+    m_sourceHash = hash;
+
+    if (path != m_sourceFile)
+    {
+        if (m_fileSynchronizer)
+        {
+            m_fileSynchronizer->deleteLater();
+            m_fileSynchronizer = NULL;
+        }
+
+        m_sourceFile = path;
+
+        if (!m_sourceFile.isEmpty() && m_isLoaded)
+        {
+            m_fileSynchronizer = new PlaylistSynchronizer(this, m_sourceFile, FileSynchronization);
+        }
+    }
+
+    emit modified();
+}
+
 void PlaylistModel::setCreationDate(const QDateTime &date)
 {
     if (date.isValid())
@@ -337,6 +701,30 @@ void PlaylistModel::setCurrentTrack(int track, PlayerReaction reaction)
         m_currentTrack = 0;
     }
 
+    const int id = trackId(m_currentTrack);
+
+    if (m_playbackMode == RandomMode && id != m_currentTrackId && !m_isRewinding)
+    {
+        if (trackRow(m_currentTrackId) >= 0)
+        {
+            m_history.append(m_currentTrackId);
+
+            if (m_history.count() > 100)
+            {
+                m_history.removeFirst();
+            }
+        }
+
+        ++m_shuffleSteps;
+
+        if (m_shuffleValid && id == m_shuffleAnchor && m_shuffleSteps > 1)
+        {
+            invalidateShuffle();
+        }
+    }
+
+    m_currentTrackId = id;
+
     emit currentTrackChanged(m_currentTrack, reaction);
     emit modified();
     emit layoutChanged();
@@ -344,17 +732,69 @@ void PlaylistModel::setCurrentTrack(int track, PlayerReaction reaction)
 
 void PlaylistModel::setPlaybackMode(PlaybackMode mode)
 {
+    if (mode != m_playbackMode)
+    {
+        m_history.clear();
+
+        invalidateShuffle();
+    }
+
     m_playbackMode = mode;
 
     emit playbackModeChanged(mode);
     emit modified();
 }
 
+void PlaylistModel::setPlayerState(PlayerState state)
+{
+    if (state == m_playerState)
+    {
+        return;
+    }
+
+    m_playerState = state;
+
+    if (m_currentTrack >= 0 && m_currentTrack < m_tracks.count())
+    {
+        emit dataChanged(index(m_currentTrack, 0), index(m_currentTrack, 0));
+    }
+}
+
+void PlaylistModel::setCurrent(bool current)
+{
+    if (current == m_isCurrent)
+    {
+        return;
+    }
+
+    m_isCurrent = current;
+
+    if (m_currentTrack >= 0 && m_currentTrack < m_tracks.count())
+    {
+        emit dataChanged(index(m_currentTrack, 0), index(m_currentTrack, 0));
+    }
+}
+
 QString PlaylistModel::title() const
 {
     return m_title;
 }
 
+QString PlaylistModel::watchedDirectory() const
+{
+    return m_watchedDirectory;
+}
+
+QString PlaylistModel::sourceFile() const
+{
+    return m_sourceFile;
+}
+
+QByteArray PlaylistModel::sourceHash() const
+{
+    return m_sourceHash;
+}
+
 QDateTime PlaylistModel::creationDate() const
 {
     return m_creationDate;
@@ -370,25 +810,27 @@ QDateTime PlaylistModel::lastPlayedDate() const
     return m_lastPlayedDate;
 }
 
-KIcon PlaylistModel::icon() const
+QIcon PlaylistModel::icon() const
 {
     switch (m_source)
     {
         case DvdSource:
-            return KIcon("media-optical-dvd");
+            return QIcon::fromTheme("media-optical-dvd");
         case VcdSource:
-            return KIcon("media-optical");
+            return QIcon::fromTheme("media-optical");
         case CdSource:
-            return KIcon("media-optical-audio");
+            return QIcon::fromTheme("media-optical-audio");
         default:
-            return KIcon("view-media-playlist");
+            return QIcon::fromTheme("view-media-playlist");
     }
 
-    return KIcon("view-media-playlist");
+    return QIcon::fromTheme("view-media-playlist");
 }
 
 QVariant PlaylistModel::data(const QModelIndex &index, int role) const
 {
+    ScopedTimer timer("PlaylistModel::data");
+
     if (!index.isValid() || (index.row() >= m_tracks.count()))
     {
         return QVariant();
@@ -398,7 +840,7 @@ QVariant PlaylistModel::data(const QModelIndex &index, int role) const
 
     if (role == Qt::DecorationRole && index.column() == FileTypeColumn && url.isValid())
     {
-        return ((index.row() == m_currentTrack)?KIcon((m_manager->state() != StoppedState && isCurrent())?"media-playback-start":"arrow-right"):MetaDataManager::icon(url));
+        return ((index.row() == m_currentTrack)?QIcon::fromTheme((m_playerState != StoppedState && isCurrent())?"media-playback-start":"arrow-right"):MetaDataManager::icon(url));
     }
     else if (role == Qt::DisplayRole || role == Qt::EditRole)
     {
@@ -469,22 +911,41 @@ QVariant PlaylistModel::headerData(int section, Qt::Orientation orientation, int
 QMimeData* PlaylistModel::mimeData(const QModelIndexList &indexes) const
 {
     KUrl::List urls;
-    QStringList rows;
+    QList<int> rows;
     const int column = (indexes.isEmpty()?-1:indexes.first().column());
 
     foreach (const QModelIndex &index, indexes)
     {
         if (index.isValid() && index.column() == column)
         {
-            urls.append(KUrl(m_tracks.at(index.row())));
+            rows.append(index.row());
+        }
+    }
+
+    qSort(rows);
 
-            rows.append(QString::number(index.row()));
+    QList<QPair<int, int> > ranges;
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        urls.append(m_tracks.at(rows.at(i)));
+
+        if (!ranges.isEmpty() && (ranges.last().first + ranges.last().second) == rows.at(i))
+        {
+            ++ranges.last().second;
+        }
+        else
+        {
+            ranges.append(qMakePair(rows.at(i), 1));
         }
     }
 
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << QCoreApplication::applicationPid() << quint64(reinterpret_cast<quintptr>(this)) << m_id << ranges;
+
     QMimeData *mimeData = new QMimeData();
-    mimeData->setData("text/x-plasma-miniplayer-tracklist", rows.join(QChar(',')).toAscii());
-    mimeData->setData("text/x-plasma-miniplayer-playlist", QString::number(m_id).toAscii());
+    mimeData->setData("application/x-plasma-miniplayer-tracks", data);
 
     urls.populateMimeData(mimeData);
 
@@ -519,12 +980,12 @@ Qt::DropActions PlaylistModel::supportedDropActions() const
 
 QStringList PlaylistModel::mimeTypes() const
 {
-    return QStringList("text/uri-list");
+    return (QStringList("application/x-plasma-miniplayer-tracks") << "text/uri-list");
 }
 
 KUrl::List PlaylistModel::tracks() const
 {
-    return m_tracks;
+    return (m_isLoaded?m_tracks:KUrl::List(m_pendingTracks));
 }
 
 KUrl PlaylistModel::track(int position) const
@@ -567,37 +1028,111 @@ MetaDataKey PlaylistModel::translateColumn(int column) const
     return InvalidKey;
 }
 
-int PlaylistModel::randomTrack() const
+void PlaylistModel::updateShuffle() const
 {
-    if (trackCount() < 2)
+    if (m_shuffleValid)
     {
-        return 0;
+        return;
     }
 
-    qsrand(QDateTime::currentDateTime().toTime_t());
+    QList<int> ids = m_trackIds;
+
+    m_randomSequence.randomize(ids);
+
+    const int position = ids.indexOf(m_currentTrackId);
 
-    KRandomSequence sequence(qrand() % 1000);
-    int randomTrack = currentTrack();
+    if (position > 0)
+    {
+        ids.swap(0, position);
+    }
 
-    while (randomTrack == currentTrack())
+    m_shuffleNext.clear();
+    m_shuffleNext.reserve(ids.count());
+    m_shufflePrevious.clear();
+    m_shufflePrevious.reserve(ids.count());
+
+    for (int i = 0; i < ids.count(); ++i)
     {
-        randomTrack = sequence.getLong(trackCount() - 1);
+        m_shuffleNext[ids.at(i)] = ids.at((i + 1) % ids.count());
+        m_shufflePrevious[ids.at(i)] = ids.at((i > 0)?(i - 1):(ids.count() - 1));
     }
 
-    return randomTrack;
+    m_shuffleAnchor = ids.value(0, -1);
+    m_shuffleSteps = 0;
+    m_shuffleValid = true;
 }
 
-int PlaylistModel::findTrack(const KUrl &url) const
+void PlaylistModel::insertShuffleTrack(int id)
 {
-    for (int i = 0; i < m_tracks.count(); ++i)
+    if (!m_shuffleValid)
     {
-        if (m_tracks.at(i) == url)
-        {
-            return i;
-        }
+        return;
+    }
+
+    if (m_shuffleNext.isEmpty())
+    {
+        m_shuffleNext[id] = id;
+        m_shufflePrevious[id] = id;
+        m_shuffleAnchor = id;
+
+        return;
+    }
+
+    int previous = m_trackIds.at(m_randomSequence.getLong(m_trackIds.count()));
+
+    if (!m_shuffleNext.contains(previous))
+    {
+        previous = m_shufflePrevious.value(m_shuffleAnchor);
+    }
+
+    const int next = m_shuffleNext.value(previous);
+
+    m_shuffleNext[previous] = id;
+    m_shuffleNext[id] = next;
+    m_shufflePrevious[next] = id;
+    m_shufflePrevious[id] = previous;
+}
+
+void PlaylistModel::removeShuffleTrack(int id)
+{
+    m_history.removeAll(id);
+
+    if (!m_shuffleValid || !m_shuffleNext.contains(id))
+    {
+        return;
+    }
+
+    const int next = m_shuffleNext.take(id);
+    const int previous = m_shufflePrevious.take(id);
+
+    if (next == id)
+    {
+        m_shuffleAnchor = -1;
+
+        return;
+    }
+
+    m_shuffleNext[previous] = next;
+    m_shufflePrevious[next] = previous;
+
+    if (m_shuffleAnchor == id)
+    {
+        m_shuffleAnchor = next;
     }
+}
 
-    return 0;
+void PlaylistModel::invalidateShuffle()
+{
+    m_shuffleNext.clear();
+    m_shufflePrevious.clear();
+    m_shuffleAnchor = -1;
+    m_shuffleSteps = 0;
+    m_shuffleValid = false;
+}
+
+int PlaylistModel::createTrackId()
+{
+    return ++m_trackIdCounter;
 }
 
 int PlaylistModel::id() const
@@ -607,7 +1142,36 @@ int PlaylistModel::id() const
 
 int PlaylistModel::currentTrack() const
 {
-    return m_currentTrack;
+    return (m_isLoaded?m_currentTrack:m_pendingCurrentTrack);
+}
+
+int PlaylistModel::trackId(int position) const
+{
+    return m_trackIds.value(position, -1);
+}
+
+int PlaylistModel::trackRow(int id) const
+{
+    int row = m_trackRows.value(id, -1);
+
+    if (row >= 0 && row < m_validTrackRows)
+    {
+        return row;
+    }
+
+    if (m_validTrackRows < m_trackIds.count())
+    {
+        for (int i = m_validTrackRows; i < m_trackIds.count(); ++i)
+        {
+            m_trackRows[m_trackIds.at(i)] = i;
+        }
+
+        m_validTrackRows = m_trackIds.count();
+
+        row = m_trackRows.value(id, -1);
+    }
+
+    return ((row >= 0 && row < m_trackIds.count())?row:-1);
 }
 
 int PlaylistModel::nextTrack() const
@@ -620,14 +1184,22 @@ int PlaylistModel::nextTrack() const
     switch (m_playbackMode)
     {
         case RandomMode:
-            return randomTrack();
+            if (m_tracks.count() < 2)
+            {
+                return 0;
+            }
+
+            updateShuffle();
+
+            return trackRow(m_shuffleNext.value(m_currentTrackId, m_shuffleAnchor));
         case LoopTrackMode:
             return m_currentTrack;
         case LoopPlaylistMode:
+        case CrossfadeMode:
         default:
             if ((m_currentTrack + 1) >= m_tracks.count())
             {
-                return ((m_playbackMode == LoopPlaylistMode)?0:-1);
+                return ((m_playbackMode == LoopPlaylistMode || m_playbackMode == CrossfadeMode)?0:-1);
             }
 
             return (m_currentTrack + 1);
@@ -674,7 +1246,7 @@ bool PlaylistModel::dropMimeData(const QMimeData *mimeData, Qt::DropAction actio
         return true;
     }
 
-    if (isReadOnly() || !mimeData->hasUrls())
+    if (isReadOnly() || !(mimeData->hasUrls() || mimeData->hasFormat("application/x-plasma-miniplayer-tracks")))
     {
         return false;
     }
@@ -690,28 +1262,26 @@ bool PlaylistModel::dropMimeData(const QMimeData *mimeData, Qt::DropAction actio
         position = row;
     }
 
-    const KUrl::List urls = KUrl::List::fromMimeData(mimeData);
-
-    addTracks(urls, position, NoReaction);
-
-    if (action == Qt::MoveAction && mimeData->hasFormat("text/x-plasma-miniplayer-tracklist") && mimeData->data("text/x-plasma-miniplayer-playlist") == QString::number(m_id))
+    if (action == Qt::MoveAction)
     {
-        QList<int> rows;
-        const QStringList data = QString(mimeData->data("text/x-plasma-miniplayer-tracklist")).split(',');
+        const PlaylistModel *playlist = NULL;
+        const QList<int> rows = decodeRows(mimeData, &playlist);
 
-        for (int i = 0; i < data.count(); ++i)
+        if (playlist == this)
         {
-            rows.append(data.at(i).toInt());
-        }
+            moveTracks(rows, position);
 
-        qSort(rows);
-
-        for (int i = (rows.count() - 1); i >= 0; --i)
-        {
-            removeTrack(rows.at(i) + ((rows.at(i) >= position)?urls.count():0));
+            return true;
         }
     }
 
+    if (copyTracks(mimeData, position))
+    {
+        return true;
+    }
+
+    addTracks(KUrl::List::fromMimeData(mimeData), position, NoReaction);
+
     return true;
 }
 
@@ -729,8 +1299,15 @@ bool PlaylistModel::insertRows(int row, int count, const QModelIndex &index)
     for (int i = 0; i < count; ++i)
     {
         m_tracks.insert((row + i), KUrl());
+        m_trackIds.insert((row + i), createTrackId());
+
+        insertShuffleTrack(m_trackIds.at(row + i));
     }
 
+    invalidateTrackRows(row);
+
+    recordCommand(InsertTracksCommand, row, m_tracks.mid(row, count));
+
     endInsertRows();
 
     if (row <= m_currentTrack)
@@ -760,15 +1337,25 @@ bool PlaylistModel::removeRows(int row, int count, const QModelIndex &index)
         removedTracks.append(m_tracks.at(row));
 
         m_tracks.removeAt(row);
+
+        const int id = m_trackIds.takeAt(row);
+
+        m_trackRows.remove(id);
+
+        removeShuffleTrack(id);
     }
 
+    invalidateTrackRows(row);
+
     endRemoveRows();
 
-    m_manager->removeTracks(removedTracks);
+    recordCommand(RemoveTracksCommand, row, removedTracks);
+
+    emit tracksRemoved(removedTracks);
 
     if (row < m_currentTrack)
     {
-        setCurrentTrack((m_currentTrack - count), ((m_currentTrack >= row && m_currentTrack <= end && (m_manager->state() != StoppedState && isCurrent()))?StopReaction:NoReaction));
+        setCurrentTrack((m_currentTrack - count), ((m_currentTrack >= row && m_currentTrack <= end && (m_playerState != StoppedState && isCurrent()))?StopReaction:NoReaction));
     }
     else
     {
@@ -778,6 +1365,640 @@ bool PlaylistModel::removeRows(int row, int count, const QModelIndex &index)
     return true;
 }
 
+bool PlaylistModel::moveRows(int sourceRow, int count, const QModelIndex &index, int destinationRow)
+{
+    if (index.isValid() || count < 1 || sourceRow < 0 || (sourceRow + count) > m_tracks.count() || destinationRow < 0 || destinationRow > m_tracks.count())
+    {
+        return false;
+    }
+
+    if (!beginMoveRows(index, sourceRow, (sourceRow + count - 1), index, destinationRow))
+    {
+        return false;
+    }
+
+    const int id = trackId(m_currentTrack);
+    QList<int> rows;
+    rows.reserve(m_tracks.count());
+
+    for (int i = 0; i < m_tracks.count(); ++i)
+    {
+        if (i == destinationRow)
+        {
+            for (int j = sourceRow; j < (sourceRow + count); ++j)
+            {
+                rows.append(j);
+            }
+        }
+
+        if (i < sourceRow || i >= (sourceRow + count))
+        {
+            rows.append(i);
+        }
+    }
+
+    if (destinationRow == m_tracks.count())
+    {
+        for (int j = sourceRow; j < (sourceRow + count); ++j)
+        {
+            rows.append(j);
+        }
+    }
+
+    reorderTracks(rows);
+
+    endMoveRows();
+
+    setCurrentTrack(qMax(0, trackRow(id)));
+
+    emit tracksChanged();
+    emit modified();
+
+    return true;
+}
+
+bool PlaylistModel::moveTracks(QList<int> rows, int position)
+{
+    ScopedTimer timer("PlaylistModel::moveTracks");
+
+    qSort(rows);
+
+    for (int i = (rows.count() - 1); i >= 0; --i)
+    {
+        if (rows.at(i) < 0 || rows.at(i) >= m_tracks.count() || (i > 0 && rows.at(i) == rows.at(i - 1)))
+        {
+            rows.removeAt(i);
+        }
+    }
+
+    if (rows.isEmpty())
+    {
+        return false;
+    }
+
+    position = qBound(0, position, m_tracks.count());
+
+    if ((rows.last() - rows.first() + 1) == rows.count())
+    {
+        return moveRows(rows.first(), rows.count(), QModelIndex(), position);
+    }
+
+    QVector<bool> selected(m_tracks.count(), false);
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        selected[rows.at(i)] = true;
+    }
+
+    QList<int> order;
+    order.reserve(m_tracks.count());
+
+    for (int i = 0; i < m_tracks.count(); ++i)
+    {
+        if (i == position)
+        {
+            order.append(rows);
+        }
+
+        if (!selected.at(i))
+        {
+            order.append(i);
+        }
+    }
+
+    if (position == m_tracks.count())
+    {
+        order.append(rows);
+    }
+
+    permuteTracks(order);
+
+    return true;
+}
+
+bool PlaylistModel::copyTracks(const QMimeData *mimeData, int position)
+{
+    const PlaylistModel *playlist = NULL;
+    const QList<int> rows = decodeRows(mimeData, &playlist);
+
+    if (!playlist)
+    {
+        return false;
+    }
+
+    KUrl::List tracks;
+    tracks.reserve(rows.count());
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        tracks.append(playlist->track(rows.at(i)));
+    }
+
+    insertTracks(tracks, position);
+
+    return true;
+}
+
+PlaylistModel* PlaylistModel::findPlaylist(int id, quintptr handle) const
+{
+    if (reinterpret_cast<quintptr>(this) == handle)
+    {
+        return ((id == m_id)?const_cast<PlaylistModel*>(this):NULL);
+    }
+
+    if (!parent())
+    {
+        return NULL;
+    }
+
+    const QObjectList children = parent()->children();
+
+    for (int i = 0; i < children.count(); ++i)
+    {
+        if (reinterpret_cast<quintptr>(children.at(i)) == handle)
+        {
+            PlaylistModel *playlist = qobject_cast<PlaylistModel*>(children.at(i));
+
+            return ((playlist && playlist->id() == id)?playlist:NULL);
+        }
+    }
+
+    return NULL;
+}
+
+QList<int> PlaylistModel::decodeRows(const QMimeData *mimeData, const PlaylistModel **playlist) const
+{
+    QList<int> rows;
+
+    *playlist = NULL;
+
+    if (!mimeData->hasFormat("application/x-plasma-miniplayer-tracks"))
+    {
+        return rows;
+    }
+
+    QByteArray data = mimeData->data("application/x-plasma-miniplayer-tracks");
+    QDataStream stream(&data, QIODevice::ReadOnly);
+    QList<QPair<int, int> > ranges;
+    qint64 process = 0;
+    quint64 handle = 0;
+    int id = -1;
+
+    stream >> process >> handle >> id >> ranges;
+
+    if (stream.status() != QDataStream::Ok || process != QCoreApplication::applicationPid())
+    {
+        return rows;
+    }
+
+    const PlaylistModel *source = findPlaylist(id, handle);
+
+    if (!source || !source->isLoaded())
+    {
+        return rows;
+    }
+
+    for (int i = 0; i < ranges.count(); ++i)
+    {
+        for (int j = ranges.at(i).first; j < (ranges.at(i).first + ranges.at(i).second) && j < source->trackCount(); ++j)
+        {
+            rows.append(j);
+        }
+    }
+
+    *playlist = source;
+
+    return rows;
+}
+
+void PlaylistModel::replayCommand(PlaylistCommandType type, int position, const KUrl::List &tracks, const QList<int> &rows, bool undo)
+{
+    ScopedTimer timer("PlaylistModel::replayCommand");
+
+    m_isReplaying = true;
+
+    bool isApplied = true;
+
+    if (type == PermuteTracksCommand)
+    {
+        if (rows.count() != m_tracks.count())
+        {
+            isApplied = false;
+        }
+        else if (undo)
+        {
+            QVector<int> inverse(rows.count());
+
+            for (int i = 0; i < rows.count(); ++i)
+            {
+                inverse[rows.at(i)] = i;
+            }
+
+            permuteTracks(inverse.toList());
+        }
+        else
+        {
+            permuteTracks(rows);
+        }
+    }
+    else if ((type == InsertTracksCommand) == undo)
+    {
+        if (tracks.isEmpty() || m_tracks.mid(position, tracks.count()) != tracks)
+        {
+            isApplied = false;
+        }
+        else
+        {
+            removeRange(position, tracks.count());
+        }
+    }
+    else if (position < 0 || position > m_tracks.count())
+    {
+        isApplied = false;
+    }
+    else
+    {
+        KUrl::List unresolvedTracks;
+
+        for (int i = 0; i < tracks.count(); ++i)
+        {
+            if (!MetaDataManager::isAvailable(tracks.at(i)))
+            {
+                unresolvedTracks.append(tracks.at(i));
+            }
+        }
+
+        insertTracks(tracks, position);
+
+        if (!unresolvedTracks.isEmpty())
+        {
+            MetaDataManager::resolveTracks(unresolvedTracks);
+        }
+    }
+
+    m_isReplaying = false;
+
+    if (!isApplied)
+    {
+        QTimer::singleShot(0, this, SLOT(discardHistory()));
+
+        emit errorOccured(i18n("Playlist was changed outside of edit history, cannot undo or redo this change."));
+    }
+}
+
+void PlaylistModel::recordCommand(PlaylistCommandType type, int position, const KUrl::List &tracks, const QList<int> &rows)
+{
+    if (m_isReplaying)
+    {
+        return;
+    }
+
+    if (m_isSynchronizing)
+    {
+        m_undoStack->clear();
+    }
+    else
+    {
+        m_undoStack->push(new PlaylistCommand(this, type, position, tracks, rows));
+    }
+}
+
+void PlaylistModel::discardHistory()
+{
+    m_undoStack->clear();
+}
+
+void PlaylistModel::permuteTracks(const QList<int> &rows)
+{
+    if (rows.count() != m_tracks.count())
+    {
+        return;
+    }
+
+    const int id = trackId(m_currentTrack);
+
+    emit layoutAboutToBeChanged();
+
+    QVector<int> positions(rows.count());
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        positions[rows.at(i)] = i;
+    }
+
+    const QModelIndexList indexes = persistentIndexList();
+
+    for (int i = 0; i < indexes.count(); ++i)
+    {
+        changePersistentIndex(indexes.at(i), this->index(positions.at(indexes.at(i).row()), indexes.at(i).column()));
+    }
+
+    reorderTracks(rows);
+
+    emit layoutChanged();
+
+    setCurrentTrack(qMax(0, trackRow(id)));
+
+    emit tracksChanged();
+    emit modified();
+}
+
+void PlaylistModel::removeTracks(QList<int> rows)
+{
+    if (rows.isEmpty())
+    {
+        return;
+    }
+
+    ScopedTimer timer("PlaylistModel::removeTracks");
+
+    QVector<bool> removedRows(m_tracks.count(), false);
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (rows.at(i) >= 0 && rows.at(i) < m_tracks.count())
+        {
+            removedRows[rows.at(i)] = true;
+        }
+    }
+
+    int removedCount = 0;
+    int removedRanges = 0;
+
+    for (int i = 0; i < removedRows.count(); ++i)
+    {
+        if (removedRows.at(i))
+        {
+            ++removedCount;
+
+            if (i == 0 || !removedRows.at(i - 1))
+            {
+                ++removedRanges;
+            }
+        }
+    }
+
+    if (removedCount == 0)
+    {
+        return;
+    }
+
+    const bool isMacro = (removedRanges > 1 && !m_isReplaying && !m_isSynchronizing);
+
+    if (isMacro)
+    {
+        m_undoStack->beginMacro(i18np("Remove track", "Remove %1 tracks", removedCount));
+    }
+
+    for (int i = (m_tracks.count() - 1); i >= 0; --i)
+    {
+        if (!removedRows.at(i))
+        {
+            continue;
+        }
+
+        const int end = i;
+
+        while (i > 0 && removedRows.at(i - 1))
+        {
+            --i;
+        }
+
+        recordCommand(RemoveTracksCommand, i, m_tracks.mid(i, (end - i + 1)));
+    }
+
+    if (isMacro)
+    {
+        m_undoStack->endMacro();
+    }
+
+    KUrl::List removedTracks;
+    KUrl::List tracks;
+    QList<int> trackIds;
+    int firstRow = -1;
+    int previousTracks = 0;
+    bool isCurrentRemoved = false;
+
+    for (int i = 0; i < m_tracks.count(); ++i)
+    {
+        if (!removedRows.at(i))
+        {
+            tracks.append(m_tracks.at(i));
+            trackIds.append(m_trackIds.at(i));
+
+            continue;
+        }
+
+        if (firstRow < 0)
+        {
+            firstRow = i;
+        }
+
+        if (i < m_currentTrack)
+        {
+            ++previousTracks;
+        }
+        else if (i == m_currentTrack)
+        {
+            isCurrentRemoved = true;
+        }
+
+        removedTracks.append(m_tracks.at(i));
+
+        m_trackRows.remove(m_trackIds.at(i));
+
+        removeShuffleTrack(m_trackIds.at(i));
+    }
+
+    if (removedTracks.isEmpty())
+    {
+        return;
+    }
+
+    emit tracksRemoved(removedTracks);
+
+    m_tracks = tracks;
+    m_trackIds = trackIds;
+
+    invalidateTrackRows(firstRow);
+
+    if (isCurrentRemoved)
+    {
+        setCurrentTrack((m_currentTrack - previousTracks - 1), ((m_playerState != StoppedState && isCurrent())?StopReaction:NoReaction));
+    }
+    else
+    {
+        setCurrentTrack(m_currentTrack - previousTracks);
+    }
+
+    emit tracksChanged();
+    emit modified();
+}
+
+void PlaylistModel::applyTracks(const KUrl::List &tracks, const QList<int> &rows)
+{
+    ScopedTimer timer("PlaylistModel::applyTracks");
+
+    load();
+
+    QVector<bool> keptTracks(m_tracks.count(), false);
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (rows.at(i) >= 0 && rows.at(i) < m_tracks.count())
+        {
+            keptTracks[rows.at(i)] = true;
+        }
+    }
+
+    QVector<int> positions(m_tracks.count(), -1);
+    QList<int> removedRows;
+    int position = 0;
+
+    for (int i = 0; i < m_tracks.count(); ++i)
+    {
+        if (keptTracks.at(i))
+        {
+            positions[i] = position;
+
+            ++position;
+        }
+        else
+        {
+            removedRows.append(i);
+        }
+    }
+
+    QList<int> order;
+    bool isOrdered = true;
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (rows.at(i) >= 0 && rows.at(i) < positions.count())
+        {
+            isOrdered = (isOrdered && positions.at(rows.at(i)) == order.count());
+
+            order.append(positions.at(rows.at(i)));
+        }
+    }
+
+    removeTracks(removedRows);
+
+    if (!isOrdered)
+    {
+        permuteTracks(order);
+    }
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (rows.at(i) >= 0 && rows.at(i) < positions.count())
+        {
+            continue;
+        }
+
+        const int start = i;
+        KUrl::List addedTracks;
+
+        while (i < rows.count() && (rows.at(i) < 0 || rows.at(i) >= positions.count()))
+        {
+            addedTracks.append(tracks.at(i));
+
+            ++i;
+        }
+
+        insertTracks(addedTracks, start);
+    }
+}
+
+void PlaylistModel::setSynchronizing(bool synchronizing)
+{
+    m_isSynchronizing = synchronizing;
+}
+
+void PlaylistModel::removeRange(int position, int count)
+{
+    if (position < 0 || count < 1 || (position + count) > m_tracks.count())
+    {
+        return;
+    }
+
+    const KUrl::List removedTracks = m_tracks.mid(position, count);
+    const QList<int> removedIds = m_trackIds.mid(position, count);
+
+    recordCommand(RemoveTracksCommand, position, removedTracks);
+
+    emit tracksRemoved(removedTracks);
+
+    m_tracks = (m_tracks.mid(0, position) + m_tracks.mid(position + count));
+    m_trackIds = (m_trackIds.mid(0, position) + m_trackIds.mid(position + count));
+
+    invalidateTrackRows(position);
+
+    for (int i = 0; i < removedIds.count(); ++i)
+    {
+        m_trackRows.remove(removedIds.at(i));
+
+        removeShuffleTrack(removedIds.at(i));
+    }
+
+    if (m_currentTrack >= (position + count))
+    {
+        setCurrentTrack(m_currentTrack - count);
+    }
+    else if (m_currentTrack >= position)
+    {
+        setCurrentTrack((position - 1), ((m_playerState != StoppedState && isCurrent())?StopReaction:NoReaction));
+    }
+    else
+    {
+        setCurrentTrack(m_currentTrack);
+    }
+
+    emit tracksChanged();
+    emit modified();
+}
+
+void PlaylistModel::reorderTracks(const QList<int> &rows)
+{
+    recordCommand(PermuteTracksCommand, 0, KUrl::List(), rows);
+
+    const KUrl::List tracks = m_tracks;
+    const QList<int> trackIds = m_trackIds;
+
+    int position = -1;
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (position < 0 && rows.at(i) != i)
+        {
+            position = i;
+        }
+
+        m_tracks[i] = tracks.at(rows.at(i));
+        m_trackIds[i] = trackIds.at(rows.at(i));
+    }
+
+    if (position >= 0)
+    {
+        invalidateTrackRows(position);
+    }
+}
+
+void PlaylistModel::invalidateTrackRows(int position)
+{
+    m_validTrackRows = qMin(m_validTrackRows, qMax(0, position));
+}
+
+QUndoStack* PlaylistModel::undoStack() const
+{
+    return m_undoStack;
+}
+
+bool PlaylistModel::isLoaded() const
+{
+    return m_isLoaded;
+}
+
 bool PlaylistModel::isReadOnly() const
 {
     return (m_source != LocalSource);
@@ -785,7 +2006,7 @@ bool PlaylistModel::isReadOnly() const
 
 bool PlaylistModel::isCurrent() const
 {
-    return (m_id == m_manager->currentPlaylist());
+    return m_isCurrent;
 }
 
 }
@@ -21,37 +21,53 @@
 #ifndef MINIPLAYERPLAYLISTMODEL_HEADER
 #define MINIPLAYERPLAYLISTMODEL_HEADER
 
+#include <QtCore/QHash>
 #include <QtCore/QVariant>
 #include <QtCore/QDateTime>
 #include <QtCore/QMimeData>
 #include <QtCore/QAbstractTableModel>
 
+#include <QtGui/QIcon>
+
 #include <KUrl>
-#include <KIcon>
+#include <KRandomSequence>
 
 #include "Constants.h"
 
+class QUndoStack;
+
 namespace MiniPlayer
 {
 
-class PlaylistManager;
+class PlaylistSynchronizer;
 
 class PlaylistModel : public QAbstractTableModel
 {
     Q_OBJECT
 
     public:
-        explicit PlaylistModel(PlaylistManager *parent, int id, const QString &title, PlaylistSource source = LocalSource);
+        explicit PlaylistModel(QObject *parent, int id, const QString &title, PlaylistSource source = LocalSource);
 
         void addTrack(int position, const KUrl &url);
         void removeTrack(int position);
         void addTracks(const KUrl::List &tracks, int position = -1, PlayerReaction reaction = NoReaction);
+        void insertTracks(const KUrl::List &tracks, int position = -1, PlayerReaction reaction = NoReaction);
+        void removeTracks(QList<int> rows);
+        void applyTracks(const KUrl::List &tracks, const QList<int> &rows);
+        void setSynchronizing(bool synchronizing);
+        void setPendingTracks(const QStringList &tracks, int currentTrack);
+        void restoreTracks(const KUrl::List &tracks, int currentTrack);
         void sort(int column, Qt::SortOrder order);
+        void replayCommand(PlaylistCommandType type, int position, const KUrl::List &tracks, const QList<int> &rows, bool undo);
+        QUndoStack* undoStack() const;
         QString title() const;
+        QString watchedDirectory() const;
+        QString sourceFile() const;
+        QByteArray sourceHash() const;
         QDateTime creationDate() const;
         QDateTime modificationDate() const;
         QDateTime lastPlayedDate() const;
-        KIcon icon() const;
+        QIcon icon() const;
         QVariant data(const QModelIndex &index, int role) const;
         QVariant headerData(int section, Qt::Orientation orientation, int role) const;
         QMimeData* mimeData(const QModelIndexList &indexes) const;
@@ -64,6 +80,8 @@ class PlaylistModel : public QAbstractTableModel
         PlaylistSource source() const;
         int id() const;
         int currentTrack() const;
+        int trackId(int position) const;
+        int trackRow(int id) const;
         int nextTrack() const;
         int trackCount() const;
         int columnCount(const QModelIndex &index) const;
@@ -72,51 +90,103 @@ class PlaylistModel : public QAbstractTableModel
         bool dropMimeData(const QMimeData *mimeData, Qt::DropAction action, int row, int column, const QModelIndex &index);
         bool insertRows(int row, int count, const QModelIndex &index = QModelIndex());
         bool removeRows(int row, int count, const QModelIndex &index = QModelIndex());
+        bool moveRows(int sourceRow, int count, const QModelIndex &index, int destinationRow);
+        bool moveTracks(QList<int> rows, int position);
+        bool copyTracks(const QMimeData *mimeData, int position = -1);
         bool isCurrent() const;
         bool isReadOnly() const;
+        bool isLoaded() const;
 
     public slots:
+        void load();
         void clear();
         void shuffle();
         void next(PlayerReaction reaction = NoReaction);
         void previous(PlayerReaction reaction = NoReaction);
         void setTitle(const QString &title);
+        void setWatchedDirectory(const QString &directory);
+        void setSourceFile(const QString &path, const QByteArray &hash = QByteArray());
         void setCreationDate(const QDateTime &date);
         void setModificationDate(const QDateTime &date);
         void setLastPlayedDate(const QDateTime &date);
         void setCurrentTrack(int track, PlayerReaction reaction = NoReaction);
         void setPlaybackMode(PlaybackMode mode);
+        void setPlayerState(PlayerState state);
+        void setCurrent(bool current);
 
     protected:
+        void timerEvent(QTimerEvent *event);
         MetaDataKey translateColumn(int column) const;
-        int randomTrack() const;
-        int findTrack(const KUrl &url) const;
+        void updateShuffle() const;
+        void insertShuffleTrack(int id);
+        void removeShuffleTrack(int id);
+        void invalidateShuffle();
+        void invalidateTrackRows(int position);
+        void reorderTracks(const QList<int> &rows);
+        void permuteTracks(const QList<int> &rows);
+        void removeRange(int position, int count);
+        void recordCommand(PlaylistCommandType type, int position, const KUrl::List &tracks, const QList<int> &rows = QList<int>());
+        PlaylistModel* findPlaylist(int id, quintptr handle) const;
+        QList<int> decodeRows(const QMimeData *mimeData, const PlaylistModel **playlist) const;
+        int createTrackId();
 
     protected slots:
         void metaDataChanged(const KUrl &url);
         void processedTracks(const KUrl::List &tracks, int position, PlayerReaction reaction = NoReaction);
         void updateModificationDate();
+        void scheduleRevalidation();
+        void discardHistory();
 
     private:
-        PlaylistManager *m_manager;
         KUrl::List m_tracks;
+        QStringList m_pendingTracks;
+        QList<int> m_trackIds;
+        mutable QHash<int, int> m_trackRows;
+        mutable QHash<int, int> m_shuffleNext;
+        mutable QHash<int, int> m_shufflePrevious;
+        QList<int> m_history;
+        mutable KRandomSequence m_randomSequence;
+        QUndoStack *m_undoStack;
+        PlaylistSynchronizer *m_directorySynchronizer;
+        PlaylistSynchronizer *m_fileSynchronizer;
         QString m_title;
+        QString m_watchedDirectory;
+        QString m_sourceFile;
+        QByteArray m_sourceHash;
         QDateTime m_creationDate;
         QDateTime m_modificationDate;
         QDateTime m_lastPlayedDate;
         PlaybackMode m_playbackMode;
         PlaylistSource m_source;
+        PlayerState m_playerState;
         int m_id;
         int m_currentTrack;
+        int m_currentTrackId;
+        mutable int m_shuffleAnchor;
+        mutable int m_shuffleSteps;
+        mutable int m_validTrackRows;
+        int m_pendingCurrentTrack;
+        int m_revalidateTimer;
+        int m_revalidatePosition;
+        bool m_isCurrent;
+        bool m_isLoaded;
+        bool m_isRewinding;
+        bool m_isReplaying;
+        bool m_isSynchronizing;
+        mutable bool m_shuffleValid;
+
+        static int m_trackIdCounter;
 
     signals:
         void modified();
         void tracksChanged();
         void trackAdded(int track);
-        void trackRemoved(int track);
+        void trackRemoved(int track, int id);
         void trackChanged(int track);
         void currentTrackChanged(int track, PlayerReaction reaction);
         void playbackModeChanged(PlaybackMode mode);
+        void tracksRemoved(KUrl::List tracks);
+        void errorOccured(QString error);
 };
 
 }
@@ -20,6 +20,7 @@
 
 #include "PlaylistReader.h"
 #include "MetaDataManager.h"
+#include "Instrumentation.h"
 
 #include <QtCore/QDir>
 #include <QtCore/QFile>
@@ -30,7 +31,6 @@
 
 #include <KLocale>
 #include <KMimeType>
-#include <KMessageBox>
 
 namespace MiniPlayer
 {
@@ -41,6 +41,7 @@ PlaylistReader::PlaylistReader(QObject *parent, const KUrl::List &urls, int inde
     m_index(index)
 {
     connect(this, SIGNAL(processedTracks(KUrl::List,int,PlayerReaction)), parent, SLOT(processedTracks(KUrl::List,int,PlayerReaction)));
+    connect(this, SIGNAL(errorOccured(QString)), parent, SIGNAL(errorOccured(QString)));
 
     addUrls(urls);
 }
@@ -143,6 +144,8 @@ void PlaylistReader::addUrls(const KUrl::List &items, int level)
 
 void PlaylistReader::importPlaylist(const KUrl &url, PlaylistFormat format)
 {
+    ScopedTimer timer("PlaylistReader::importPlaylist");
+
     QFileInfo currentLocation(url.pathOrUrl());
 
     QDir::setCurrent(currentLocation.absolutePath());
@@ -151,7 +154,9 @@ void PlaylistReader::importPlaylist(const KUrl &url, PlaylistFormat format)
 
     if (!data.open(QFile::ReadOnly))
     {
-        KMessageBox::error(NULL, i18n("Cannot open file for reading."));
+        emit errorOccured(i18n("Cannot open file for reading."));
+
+        return;
     }
 
     if (format == XspfFormat)
@@ -213,6 +218,8 @@ void PlaylistReader::importResult(KJob *job)
 
 void PlaylistReader::readPls(QTextStream &stream)
 {
+    ScopedTimer timer("PlaylistReader::readPls");
+
     QRegExp plsUrl("^File\\d+=");
     QRegExp plsTitle("^Title\\d+=");
     QRegExp plsDuration("^Length\\d+=");
@@ -288,6 +295,8 @@ void PlaylistReader::readPls(QTextStream &stream)
 
 void PlaylistReader::readM3u(QTextStream &stream)
 {
+    ScopedTimer timer("PlaylistReader::readM3u");
+
     QRegExp m3uInformation("^#EXTINF:");
     QString line;
     KUrl::List urls;
@@ -355,6 +364,8 @@ void PlaylistReader::readM3u(QTextStream &stream)
 
 void PlaylistReader::readXspf(const QByteArray &data)
 {
+    ScopedTimer timer("PlaylistReader::readXspf");
+
     QXmlStreamReader reader(data);
     KUrl::List urls;
     KUrl url;
@@ -441,6 +452,8 @@ void PlaylistReader::readXspf(const QByteArray &data)
 
 void PlaylistReader::readAsx(const QByteArray &data)
 {
+    ScopedTimer timer("PlaylistReader::readAsx");
+
     QXmlStreamReader reader(data);
     KUrl::List urls;
     KUrl url;
@@ -502,6 +515,8 @@ void PlaylistReader::readAsx(const QByteArray &data)
 
 void PlaylistReader::readDirectory(const KUrl &url, int level)
 {
+    ScopedTimer timer("PlaylistReader::readDirectory");
+
     if (level > 9)
     {
         return;
@@ -62,6 +62,7 @@ class PlaylistReader : public QObject
 
     signals:
         void processedTracks(KUrl::List tracks, int index, PlayerReaction reaction);
+        void errorOccured(QString error);
 };
 
 }
@@ -0,0 +1,629 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "PlaylistSynchronizer.h"
+#include "PlaylistModel.h"
+#include "PlaylistReader.h"
+#include "MetaDataManager.h"
+#include "Instrumentation.h"
+#include "IdleManager.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QVector>
+#include <QtCore/QMultiHash>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QSet>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTimerEvent>
+
+#include <KDirWatch>
+#include <KMimeType>
+
+namespace MiniPlayer
+{
+
+PlaylistSynchronizer::PlaylistSynchronizer(PlaylistModel *parent, const QString &path, SynchronizationMode mode) : QObject(parent),
+    m_playlist(parent),
+    m_watcher(new KDirWatch(this)),
+    m_path(QDir::cleanPath(path)),
+    m_mode(mode),
+    m_modificationTime(0),
+    m_synchronizeTimer(0),
+    m_reconcileTimer(startTimer(300000)),
+    m_isSynchronizationPending(false)
+{
+    if (m_mode == FileSynchronization)
+    {
+        m_watcher->addFile(m_path);
+    }
+    else
+    {
+        m_watcher->addDir(m_path, (KDirWatch::WatchFiles | KDirWatch::WatchSubDirs));
+    }
+
+    connect(this, SIGNAL(errorOccured(QString)), parent, SIGNAL(errorOccured(QString)));
+
+    connect(m_watcher, SIGNAL(created(QString)), this, SLOT(fileCreated(QString)));
+    connect(m_watcher, SIGNAL(deleted(QString)), this, SLOT(fileDeleted(QString)));
+    connect(m_watcher, SIGNAL(dirty(QString)), this, SLOT(directoryChanged(QString)));
+
+    scheduleSynchronization();
+}
+
+void PlaylistSynchronizer::timerEvent(QTimerEvent *event)
+{
+    Instrumentation::recordWakeup("PlaylistSynchronizer");
+
+    if (event->timerId() == m_synchronizeTimer)
+    {
+        killTimer(m_synchronizeTimer);
+
+        m_synchronizeTimer = 0;
+
+        removeDeletedFiles();
+        addCreatedFiles();
+
+        if (!m_isSynchronizationPending)
+        {
+            return;
+        }
+
+        m_isSynchronizationPending = false;
+    }
+    else if (event->timerId() != m_reconcileTimer)
+    {
+        killTimer(event->timerId());
+
+        return;
+    }
+    else if (IdleManager::isIdle())
+    {
+        killTimer(m_reconcileTimer);
+
+        m_reconcileTimer = 0;
+
+        connect(IdleManager::instance(), SIGNAL(idleChanged(bool)), this, SLOT(resumeReconciliation(bool)), Qt::UniqueConnection);
+
+        return;
+    }
+    else if (IdleManager::isHidden())
+    {
+        return;
+    }
+
+    synchronize();
+}
+
+void PlaylistSynchronizer::scheduleSynchronization(bool full)
+{
+    m_isSynchronizationPending = (m_isSynchronizationPending || full);
+
+    if (!m_synchronizeTimer)
+    {
+        m_synchronizeTimer = startTimer(1000);
+    }
+}
+
+void PlaylistSynchronizer::resumeReconciliation(bool idle)
+{
+    if (idle || m_reconcileTimer)
+    {
+        return;
+    }
+
+    disconnect(IdleManager::instance(), SIGNAL(idleChanged(bool)), this, SLOT(resumeReconciliation(bool)));
+
+    m_reconcileTimer = startTimer(300000);
+
+    scheduleSynchronization();
+}
+
+void PlaylistSynchronizer::addCreatedFiles()
+{
+    if (m_createdFiles.isEmpty())
+    {
+        return;
+    }
+
+    ScopedTimer timer("PlaylistSynchronizer::addCreatedFiles");
+
+    QSet<QString> createdFiles = m_createdFiles;
+
+    m_createdFiles.clear();
+
+    const KUrl::List tracks = m_playlist->tracks();
+
+    for (int i = 0; i < tracks.count(); ++i)
+    {
+        if (tracks.at(i).isLocalFile())
+        {
+            createdFiles.remove(tracks.at(i).toLocalFile());
+        }
+    }
+
+    if (createdFiles.isEmpty())
+    {
+        return;
+    }
+
+    QStringList addedFiles = createdFiles.toList();
+    addedFiles.sort();
+
+    const KUrl::List addedTracks(addedFiles);
+
+    m_playlist->setSynchronizing(true);
+    m_playlist->insertTracks(addedTracks);
+    m_playlist->setSynchronizing(false);
+
+    MetaDataManager::resolveTracks(addedTracks);
+}
+
+void PlaylistSynchronizer::synchronize()
+{
+    if (m_mode == FileSynchronization)
+    {
+        synchronizeFile();
+    }
+    else
+    {
+        synchronizeDirectory();
+    }
+}
+
+void PlaylistSynchronizer::synchronizeFile()
+{
+    ScopedTimer timer("PlaylistSynchronizer::synchronizeFile");
+
+    const QFileInfo information(m_path);
+
+    if (!information.isFile() || information.lastModified().toTime_t() == m_modificationTime)
+    {
+        return;
+    }
+
+    m_modificationTime = information.lastModified().toTime_t();
+
+    QFile file(m_path);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    while (!file.atEnd())
+    {
+        hash.addData(file.read(65536));
+    }
+
+    const QByteArray result = hash.result().toHex();
+
+    if (result == m_playlist->sourceHash())
+    {
+        return;
+    }
+
+    if (m_playlist->sourceHash().isEmpty())
+    {
+        m_playlist->setSourceFile(m_path, result);
+
+        return;
+    }
+
+    m_pendingHash = result;
+
+    new PlaylistReader(this, KUrl::List(KUrl(m_path)), 0, NoReaction);
+}
+
+void PlaylistSynchronizer::processedTracks(const KUrl::List &tracks, int position, PlayerReaction reaction)
+{
+    Q_UNUSED(position)
+    Q_UNUSED(reaction)
+
+    ScopedTimer timer("PlaylistSynchronizer::processedTracks");
+
+    const QList<int> rows = matchTracks(m_playlist->tracks(), tracks);
+    KUrl::List addedTracks;
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (rows.at(i) < 0)
+        {
+            addedTracks.append(tracks.at(i));
+        }
+    }
+
+    m_playlist->setSynchronizing(true);
+    m_playlist->applyTracks(tracks, rows);
+    m_playlist->setSynchronizing(false);
+    m_playlist->setSourceFile(m_path, m_pendingHash);
+
+    if (!addedTracks.isEmpty())
+    {
+        MetaDataManager::resolveTracks(addedTracks);
+    }
+}
+
+void PlaylistSynchronizer::synchronizeDirectory()
+{
+    ScopedTimer timer("PlaylistSynchronizer::synchronizeDirectory");
+
+    const QString prefix = (m_path + QChar('/'));
+    const KUrl::List tracks = m_playlist->tracks();
+    QHash<QString, QSet<QString> > files;
+
+    for (int i = 0; i < tracks.count(); ++i)
+    {
+        if (!tracks.at(i).isLocalFile())
+        {
+            continue;
+        }
+
+        const QString path = tracks.at(i).toLocalFile();
+
+        if (path.startsWith(prefix))
+        {
+            files[path.left(path.lastIndexOf(QChar('/')))].insert(path);
+        }
+    }
+
+    QHash<QString, WatchedDirectory> directories;
+    QStringList pendingDirectories(m_path);
+    QStringList addedFiles;
+    QSet<QString> removedFiles;
+
+    while (!pendingDirectories.isEmpty())
+    {
+        const QString path = pendingDirectories.takeLast();
+
+        if (directories.contains(path))
+        {
+            continue;
+        }
+
+        const QFileInfo information(path);
+
+        if (!information.isDir())
+        {
+            continue;
+        }
+
+        WatchedDirectory directory = m_directories.value(path);
+        const uint modificationTime = information.lastModified().toTime_t();
+
+        if (!m_directories.contains(path) || directory.modificationTime != modificationTime)
+        {
+            const QDir directoryEntries(path);
+            const QStringList subdirectories = directoryEntries.entryList(QDir::Readable | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+            const QStringList entries = directoryEntries.entryList(QDir::Readable | QDir::Files);
+            QSet<QString> existingFiles = files.value(path);
+
+            directory.modificationTime = modificationTime;
+            directory.directories.clear();
+
+            for (int i = 0; i < subdirectories.count(); ++i)
+            {
+                directory.directories.append(path + QChar('/') + subdirectories.at(i));
+            }
+
+            for (int i = 0; i < entries.count(); ++i)
+            {
+                const QString filePath = (path + QChar('/') + entries.at(i));
+
+                if (!existingFiles.remove(filePath) && isMedia(filePath))
+                {
+                    addedFiles.append(filePath);
+                }
+            }
+
+            removedFiles.unite(existingFiles);
+        }
+
+        directories[path] = directory;
+
+        pendingDirectories.append(directory.directories);
+    }
+
+    QHash<QString, QSet<QString> >::iterator iterator;
+
+    for (iterator = files.begin(); iterator != files.end(); ++iterator)
+    {
+        if (!directories.contains(iterator.key()))
+        {
+            removedFiles.unite(iterator.value());
+        }
+    }
+
+    m_directories = directories;
+
+    if (!removedFiles.isEmpty())
+    {
+        QList<int> rows;
+
+        for (int i = 0; i < tracks.count(); ++i)
+        {
+            if (tracks.at(i).isLocalFile() && removedFiles.contains(tracks.at(i).toLocalFile()))
+            {
+                rows.append(i);
+            }
+        }
+
+        m_playlist->setSynchronizing(true);
+        m_playlist->removeTracks(rows);
+        m_playlist->setSynchronizing(false);
+    }
+
+    if (!addedFiles.isEmpty())
+    {
+        addedFiles.sort();
+
+        const KUrl::List addedTracks(addedFiles);
+
+        m_playlist->setSynchronizing(true);
+        m_playlist->insertTracks(addedTracks);
+        m_playlist->setSynchronizing(false);
+
+        MetaDataManager::resolveTracks(addedTracks);
+    }
+}
+
+void PlaylistSynchronizer::removeDeletedFiles()
+{
+    if (m_deletedFiles.isEmpty())
+    {
+        return;
+    }
+
+    ScopedTimer timer("PlaylistSynchronizer::removeDeletedFiles");
+
+    const QSet<QString> deletedFiles = m_deletedFiles;
+
+    m_deletedFiles.clear();
+
+    const KUrl::List tracks = m_playlist->tracks();
+    QList<int> rows;
+
+    for (int i = 0; i < tracks.count(); ++i)
+    {
+        if (!tracks.at(i).isLocalFile())
+        {
+            continue;
+        }
+
+        QString path = tracks.at(i).toLocalFile();
+
+        while (!path.isEmpty())
+        {
+            if (deletedFiles.contains(path))
+            {
+                rows.append(i);
+
+                break;
+            }
+
+            path = path.left(path.lastIndexOf(QChar('/')));
+        }
+    }
+
+    m_playlist->setSynchronizing(true);
+    m_playlist->removeTracks(rows);
+    m_playlist->setSynchronizing(false);
+}
+
+void PlaylistSynchronizer::fileCreated(const QString &path)
+{
+    if (m_mode == FileSynchronization)
+    {
+        scheduleSynchronization();
+
+        return;
+    }
+
+    const QFileInfo information(path);
+
+    if (information.isDir())
+    {
+        scheduleSynchronization();
+    }
+    else if (information.isFile() && isMedia(path))
+    {
+        m_deletedFiles.remove(QDir::cleanPath(path));
+        m_createdFiles.insert(QDir::cleanPath(path));
+
+        scheduleSynchronization(false);
+    }
+}
+
+void PlaylistSynchronizer::fileDeleted(const QString &path)
+{
+    if (m_mode == FileSynchronization)
+    {
+        return;
+    }
+
+    m_createdFiles.remove(QDir::cleanPath(path));
+    m_deletedFiles.insert(QDir::cleanPath(path));
+
+    scheduleSynchronization(false);
+}
+
+void PlaylistSynchronizer::directoryChanged(const QString &path)
+{
+    if (m_mode == FileSynchronization || QFileInfo(path).isDir())
+    {
+        scheduleSynchronization();
+    }
+}
+
+QList<int> PlaylistSynchronizer::matchTracks(const KUrl::List &oldTracks, const KUrl::List &newTracks)
+{
+    QList<int> rows;
+    int prefix = 0;
+    int suffix = 0;
+
+    for (int i = 0; i < newTracks.count(); ++i)
+    {
+        rows.append(-1);
+    }
+
+    while (prefix < oldTracks.count() && prefix < newTracks.count() && oldTracks.at(prefix) == newTracks.at(prefix))
+    {
+        rows[prefix] = prefix;
+
+        ++prefix;
+    }
+
+    while (suffix < (oldTracks.count() - prefix) && suffix < (newTracks.count() - prefix) && oldTracks.at(oldTracks.count() - suffix - 1) == newTracks.at(newTracks.count() - suffix - 1))
+    {
+        rows[newTracks.count() - suffix - 1] = (oldTracks.count() - suffix - 1);
+
+        ++suffix;
+    }
+
+    const int oldCount = (oldTracks.count() - prefix - suffix);
+    const int newCount = (newTracks.count() - prefix - suffix);
+    const int maximum = qMin((oldCount + newCount), 1000);
+    const int offset = (maximum + 1);
+    QVector<int> furthest((2 * maximum) + 3, 0);
+    QList<QVector<int> > trace;
+    bool found = (oldCount == 0 && newCount == 0);
+
+    for (int step = 0; step <= maximum && !found; ++step)
+    {
+        for (int diagonal = -step; diagonal <= step; diagonal += 2)
+        {
+            int x = ((diagonal == -step || (diagonal != step && furthest.at(offset + diagonal - 1) < furthest.at(offset + diagonal + 1)))?furthest.at(offset + diagonal + 1):(furthest.at(offset + diagonal - 1) + 1));
+            int y = (x - diagonal);
+
+            while (x < oldCount && y < newCount && oldTracks.at(prefix + x) == newTracks.at(prefix + y))
+            {
+                ++x;
+                ++y;
+            }
+
+            furthest[offset + diagonal] = x;
+
+            if (x >= oldCount && y >= newCount)
+            {
+                found = true;
+            }
+        }
+
+        QVector<int> snapshot((2 * step) + 1);
+
+        for (int diagonal = -step; diagonal <= step; diagonal += 2)
+        {
+            snapshot[diagonal + step] = furthest.at(offset + diagonal);
+        }
+
+        trace.append(snapshot);
+    }
+
+    if (found)
+    {
+        int x = oldCount;
+        int y = newCount;
+
+        for (int step = (trace.count() - 1); step >= 0; --step)
+        {
+            const int diagonal = (x - y);
+            int startX = 0;
+            int previousX = 0;
+            int previousY = 0;
+
+            if (step > 0)
+            {
+                const QVector<int> &previous = trace.at(step - 1);
+                const bool down = (diagonal == -step || (diagonal != step && previous.at(diagonal - 1 + step - 1) < previous.at(diagonal + 1 + step - 1)));
+                const int previousDiagonal = (down?(diagonal + 1):(diagonal - 1));
+
+                previousX = previous.at(previousDiagonal + step - 1);
+                previousY = (previousX - previousDiagonal);
+                startX = (down?previousX:(previousX + 1));
+            }
+
+            while (x > startX && (x - diagonal) > 0)
+            {
+                --x;
+
+                rows[prefix + x - diagonal] = (prefix + x);
+            }
+
+            x = previousX;
+            y = previousY;
+        }
+    }
+
+    QVector<bool> matched(oldTracks.count(), false);
+
+    for (int i = 0; i < rows.count(); ++i)
+    {
+        if (rows.at(i) >= 0)
+        {
+            matched[rows.at(i)] = true;
+        }
+    }
+
+    QMultiHash<QString, int> unmatchedTracks;
+
+    for (int i = (oldTracks.count() - 1); i >= 0; --i)
+    {
+        if (!matched.at(i))
+        {
+            unmatchedTracks.insert(oldTracks.at(i).url(), i);
+        }
+    }
+
+    for (int i = 0; i < rows.count() && !unmatchedTracks.isEmpty(); ++i)
+    {
+        if (rows.at(i) < 0 && unmatchedTracks.contains(newTracks.at(i).url()))
+        {
+            rows[i] = unmatchedTracks.take(newTracks.at(i).url());
+        }
+    }
+
+    return rows;
+}
+
+QString PlaylistSynchronizer::path() const
+{
+    return m_path;
+}
+
+SynchronizationMode PlaylistSynchronizer::mode() const
+{
+    return m_mode;
+}
+
+bool PlaylistSynchronizer::isMedia(const QString &path) const
+{
+    const QString mimeType = KMimeType::findByPath(path, 0, true)->name();
+
+    if (mimeType == "audio/x-scpls" || mimeType == "audio/x-mpegurl" || mimeType == "audio/x-ms-asx")
+    {
+        return false;
+    }
+
+    return (mimeType.indexOf("video/") >= 0 || mimeType.indexOf("audio/") >= 0 || mimeType == "application/ogg");
+}
+
+}
@@ -0,0 +1,96 @@
+/***********************************************************************************
+* Mini Player: Advanced media player for Plasma.
+* Copyright (C) 2008 - 2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef MINIPLAYERPLAYLISTSYNCHRONIZER_HEADER
+#define MINIPLAYERPLAYLISTSYNCHRONIZER_HEADER
+
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+#include <KUrl>
+
+#include "Constants.h"
+
+class KDirWatch;
+
+namespace MiniPlayer
+{
+
+class PlaylistModel;
+
+struct WatchedDirectory
+{
+    WatchedDirectory() : modificationTime(0) {}
+
+    QStringList directories;
+    uint modificationTime;
+};
+
+class PlaylistSynchronizer : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit PlaylistSynchronizer(PlaylistModel *parent, const QString &path, SynchronizationMode mode = DirectorySynchronization);
+
+        static QList<int> matchTracks(const KUrl::List &oldTracks, const KUrl::List &newTracks);
+        QString path() const;
+        SynchronizationMode mode() const;
+
+    protected:
+        void timerEvent(QTimerEvent *event);
+        void scheduleSynchronization(bool full = true);
+        void synchronizeDirectory();
+        void addCreatedFiles();
+        void synchronizeFile();
+        void removeDeletedFiles();
+        bool isMedia(const QString &path) const;
+
+    protected slots:
+        void synchronize();
+        void processedTracks(const KUrl::List &tracks, int position, PlayerReaction reaction);
+        void fileCreated(const QString &path);
+        void fileDeleted(const QString &path);
+        void directoryChanged(const QString &path);
+        void resumeReconciliation(bool idle);
+
+    private:
+        PlaylistModel *m_playlist;
+        KDirWatch *m_watcher;
+        QHash<QString, WatchedDirectory> m_directories;
+        QSet<QString> m_createdFiles;
+        QSet<QString> m_deletedFiles;
+        QString m_path;
+        QByteArray m_pendingHash;
+        SynchronizationMode m_mode;
+        uint m_modificationTime;
+        int m_synchronizeTimer;
+        int m_reconcileTimer;
+        bool m_isSynchronizationPending;
+
+    signals:
+        void errorOccured(QString error);
+};
+
+}
+
+#endif
@@ -21,6 +21,8 @@
 #include "SeekSlider.h"
 #include "Player.h"
 #include "MetaDataManager.h"
+#include "IdleManager.h"
+#include "Instrumentation.h"
 
 #include <QtGui/QStyle>
 #include <QtGui/QMouseEvent>
@@ -31,7 +33,6 @@ namespace MiniPlayer
 
 SeekSlider::SeekSlider(QWidget *parent) : QSlider(parent),
     m_player(NULL),
-    m_updatePosition(0),
     m_isDragged(false)
 {
     setEnabled(false);
@@ -58,8 +59,6 @@ void SeekSlider::mousePressEvent(QMouseEvent *event)
         QRect handle = style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderHandle, this);
         int position;
 
-        killTimer(m_updatePosition);
-
         if (orientation() == Qt::Horizontal)
         {
             position = QStyle::sliderValueFromPosition(0, 10000, (event->x() - (handle.width() / 2) - groove.x()), (groove.right() - handle.width()));
@@ -102,24 +101,64 @@ void SeekSlider::mouseMoveEvent(QMouseEvent *event)
     QSlider::mouseMoveEvent(event);
 }
 
-void SeekSlider::timerEvent(QTimerEvent *event)
+void SeekSlider::showEvent(QShowEvent *event)
+{
+    QSlider::showEvent(event);
+
+    mediaChanged();
+}
+
+void SeekSlider::hideEvent(QHideEvent *event)
+{
+    QSlider::hideEvent(event);
+
+    updateTickInterval();
+}
+
+void SeekSlider::resizeEvent(QResizeEvent *event)
 {
-    Q_UNUSED(event)
+    QSlider::resizeEvent(event);
 
+    updateTickInterval();
+}
+
+void SeekSlider::updateTickInterval()
+{
     if (!m_player)
     {
         return;
     }
 
-    const int position = ((m_player->duration() > 0)?((m_player->position() * 10000) / m_player->duration()):0);
+    if (!isVisible() || IdleManager::isHidden() || m_player->state() != PlayingState || m_player->duration() < 1)
+    {
+        m_player->setTickInterval(this, 0);
+
+        return;
+    }
+
+    const int length = qMax(1, ((orientation() == Qt::Horizontal)?width():height()));
+
+    m_player->setTickInterval(this, qBound((qint64) 100, (m_player->duration() / length), (qint64) 1000));
+}
+
+void SeekSlider::updatePosition(qint64 position)
+{
+    Instrumentation::recordWakeup("SeekSlider");
+
+    if (!m_player || isSliderDown())
+    {
+        return;
+    }
+
+    const int value = ((m_player->duration() > 0)?((position * 10000) / m_player->duration()):0);
 
-    if (!isSliderDown() && position != value())
+    if (value != this->value())
     {
-        disconnect(this, SIGNAL(valueChanged(int)), this, SLOT(positionChanged(int)));
+        blockSignals(true);
 
-        setValue(position);
+        setValue(value);
 
-        connect(this, SIGNAL(valueChanged(int)), this, SLOT(positionChanged(int)));
+        blockSignals(false);
     }
 }
 
@@ -130,6 +169,10 @@ void SeekSlider::setPlayer(Player *player)
         disconnect(m_player, SIGNAL(currentTrackChanged()), this, SLOT(mediaChanged()));
         disconnect(m_player, SIGNAL(seekableChanged(bool)), this, SLOT(mediaChanged()));
         disconnect(m_player, SIGNAL(stateChanged(PlayerState)), this, SLOT(mediaChanged()));
+        disconnect(m_player, SIGNAL(durationChanged(qint64)), this, SLOT(mediaChanged()));
+        disconnect(m_player, SIGNAL(tick(qint64)), this, SLOT(updatePosition(qint64)));
+
+        m_player->setTickInterval(this, 0);
     }
 
     m_player = player;
@@ -148,17 +191,20 @@ void SeekSlider::setPlayer(Player *player)
     connect(m_player, SIGNAL(currentTrackChanged()), this, SLOT(mediaChanged()));
     connect(m_player, SIGNAL(seekableChanged(bool)), this, SLOT(mediaChanged()));
     connect(m_player, SIGNAL(stateChanged(PlayerState)), this, SLOT(mediaChanged()));
+    connect(m_player, SIGNAL(durationChanged(qint64)), this, SLOT(mediaChanged()));
+    connect(m_player, SIGNAL(tick(qint64)), this, SLOT(updatePosition(qint64)));
+
+    if (IdleManager::instance())
+    {
+        connect(IdleManager::instance(), SIGNAL(idleChanged(bool)), this, SLOT(mediaChanged()), Qt::UniqueConnection);
+    }
 }
 
 void SeekSlider::positionChanged(int position)
 {
     if (m_player)
     {
-        killTimer(m_updatePosition);
-
         m_player->setPosition((m_player->duration() * position) / 10000);
-
-        m_updatePosition = startTimer(250);
     }
 }
 
@@ -169,8 +215,6 @@ void SeekSlider::mediaChanged()
         return;
     }
 
-    killTimer(m_updatePosition);
-
     setEnabled(m_player->isSeekable() && m_player->state() != StoppedState);
 
     if (m_player->isSeekable())
@@ -185,12 +229,18 @@ void SeekSlider::mediaChanged()
 
     if (m_player->position() < 1)
     {
+        blockSignals(true);
+
         triggerAction(QAbstractSlider::SliderToMinimum);
+
+        blockSignals(false);
     }
     else
     {
-        m_updatePosition = startTimer(250);
+        updatePosition(m_player->position());
     }
+
+    updateTickInterval();
 }
 
 }
@@ -39,16 +39,19 @@ class SeekSlider : public QSlider
 
     public slots:
         void positionChanged(int position);
+        void updatePosition(qint64 position);
         void mediaChanged();
 
     protected:
         void mousePressEvent(QMouseEvent *event);
         void mouseMoveEvent(QMouseEvent *event);
-        void timerEvent(QTimerEvent *event);
+        void showEvent(QShowEvent *event);
+        void hideEvent(QHideEvent *event);
+        void resizeEvent(QResizeEvent *event);
+        void updateTickInterval();
 
     private:
         Player *m_player;
-        int m_updatePosition;
         bool m_isDragged;
 };
 
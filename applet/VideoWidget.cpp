@@ -19,7 +19,10 @@
 ***********************************************************************************/
 
 #include "VideoWidget.h"
+#include "IdleManager.h"
+#include "Instrumentation.h"
 
+#include <QtGui/QPaintEvent>
 #include <QtGui/QGraphicsSceneResizeEvent>
 
 #include <KIcon>
@@ -31,7 +34,10 @@ namespace MiniPlayer
 VideoWidget::VideoWidget(QGraphicsWidget *parent) : QGraphicsProxyWidget(parent),
    m_pixmapItem(new QGraphicsPixmapItem(KIcon("applications-multimedia").pixmap(KIconLoader::SizeEnormous), this)),
    m_backgroundWidget(new QGraphicsWidget(this)),
-   m_updateTimer(0)
+   m_updateTimer(0),
+   m_isActive(false),
+   m_isPainting(false),
+   m_hasFrames(false)
 {
     QPalette palette = this->palette();
     palette.setColor(QPalette::Window, Qt::black);
@@ -68,16 +74,128 @@ void VideoWidget::resizeEvent(QGraphicsSceneResizeEvent *event)
     m_backgroundWidget->setPos(0, 0);
 }
 
+void VideoWidget::showEvent(QShowEvent *event)
+{
+    QGraphicsProxyWidget::showEvent(event);
+
+    updateTimer();
+}
+
+void VideoWidget::hideEvent(QHideEvent *event)
+{
+    QGraphicsProxyWidget::hideEvent(event);
+
+    updateTimer();
+}
+
 void VideoWidget::timerEvent(QTimerEvent *event)
 {
     Q_UNUSED(event)
 
-    update();
+    Instrumentation::recordWakeup("VideoWidget");
+
+    if (widget())
+    {
+        update(subWidgetRect(widget()));
+    }
+}
+
+void VideoWidget::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    m_isPainting = true;
+
+    QGraphicsProxyWidget::paint(painter, option, widget);
+
+    m_isPainting = false;
+}
+
+bool VideoWidget::eventFilter(QObject *object, QEvent *event)
+{
+    if (event->type() == QEvent::ChildAdded)
+    {
+        QObject *child = static_cast<QChildEvent*>(event)->child();
+
+        if (child->isWidgetType())
+        {
+            watchWidget(static_cast<QWidget*>(child), true);
+        }
+    }
+    else if (event->type() == QEvent::Paint && !m_isPainting && widget())
+    {
+        QWidget *source = qobject_cast<QWidget*>(object);
+
+        if (source)
+        {
+            update(QRectF(static_cast<QPaintEvent*>(event)->rect().translated((source == widget())?QPoint(0, 0):source->mapTo(widget(), QPoint(0, 0)))));
+
+            if (m_isActive && !m_hasFrames)
+            {
+                m_hasFrames = true;
+
+                updateTimer();
+            }
+        }
+    }
+
+    return QGraphicsProxyWidget::eventFilter(object, event);
+}
+
+void VideoWidget::watchWidget(QWidget *surface, bool watch)
+{
+    if (watch)
+    {
+        surface->installEventFilter(this);
+    }
+    else
+    {
+        surface->removeEventFilter(this);
+    }
+
+    foreach (QWidget *child, surface->findChildren<QWidget*>())
+    {
+        if (watch)
+        {
+            child->installEventFilter(this);
+        }
+        else
+        {
+            child->removeEventFilter(this);
+        }
+    }
+}
+
+void VideoWidget::updateTimer()
+{
+    const bool needsTimer = (m_isActive && !m_hasFrames && widget() && isVisible() && !IdleManager::isHidden());
+
+    if (needsTimer && !m_updateTimer)
+    {
+        m_updateTimer = startTimer(50);
+    }
+    else if (!needsTimer && m_updateTimer)
+    {
+        killTimer(m_updateTimer);
+
+        m_updateTimer = 0;
+    }
+}
+
+void VideoWidget::setActive(bool active)
+{
+    m_isActive = active;
+    m_hasFrames = false;
+
+    updateTimer();
 }
 
 void VideoWidget::setVideoWidget(Phonon::VideoWidget *videoWidget, bool mode)
 {
-    killTimer(m_updateTimer);
+    if (widget())
+    {
+        watchWidget(widget(), false);
+    }
+
+    m_hasFrames = false;
 
     if (videoWidget)
     {
@@ -88,13 +206,15 @@ void VideoWidget::setVideoWidget(Phonon::VideoWidget *videoWidget, bool mode)
         videoWidget->show();
         videoWidget->resize(size);
 
-        m_updateTimer = startTimer(50);
+        watchWidget(videoWidget, true);
     }
     else
     {
         setWidget(NULL);
     }
 
+    updateTimer();
+
     show();
 
     m_pixmapItem->setVisible(!mode);
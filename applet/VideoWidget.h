@@ -38,17 +38,28 @@ class VideoWidget : public QGraphicsProxyWidget
     public:
         explicit VideoWidget(QGraphicsWidget *parent);
 
+        void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+        bool eventFilter(QObject *object, QEvent *event);
+
     protected slots:
         void setVideoWidget(Phonon::VideoWidget *videoWidget, bool mode);
+        void setActive(bool active);
+        void updateTimer();
 
     protected:
         void resizeEvent(QGraphicsSceneResizeEvent *event);
+        void showEvent(QShowEvent *event);
+        void hideEvent(QHideEvent *event);
         void timerEvent(QTimerEvent *event);
+        void watchWidget(QWidget *surface, bool watch);
 
     private:
         QGraphicsPixmapItem *m_pixmapItem;
         QGraphicsWidget *m_backgroundWidget;
         int m_updateTimer;
+        bool m_isActive;
+        bool m_isPainting;
+        bool m_hasFrames;
 
     friend class Player;
 };